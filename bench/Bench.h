@@ -0,0 +1,69 @@
+// bench/Bench.h
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// Keeps results alive so the optimizer can't drop the measured work
+extern volatile size_t benchSink;
+
+// Time per iteration of a benchmark
+struct BenchResult
+{
+    std::string name;
+    double nsPerOp = 0.0;
+    double mbPerSecond = 0.0; // 0 when the benchmark processes no bytes
+};
+
+// Run body `iterations` times after a short warm-up and print the time per
+// iteration; bytesPerOp (optional) adds the throughput
+template <typename Body>
+BenchResult runBench(const std::string &name, size_t iterations, Body body, size_t bytesPerOp = 0)
+{
+    for (size_t i = 0; i < iterations / 10 + 1; ++i)
+    {
+        body();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        body();
+    }
+    double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    BenchResult result;
+    result.name = name;
+    result.nsPerOp = elapsedNs / iterations;
+    if (bytesPerOp > 0)
+    {
+        result.mbPerSecond = bytesPerOp * 1e3 / result.nsPerOp;
+    }
+
+    std::cout << "  " << name << ": " << result.nsPerOp << " ns/op";
+    if (bytesPerOp > 0)
+    {
+        std::cout << ", " << result.mbPerSecond << " MB/s";
+    }
+    std::cout << std::endl;
+    return result;
+}
+
+// Print how much faster `after` is than `before`
+inline void printSpeedup(const BenchResult &before, const BenchResult &after)
+{
+    std::cout << "  => " << after.name << " is " << before.nsPerOp / after.nsPerOp << "x "
+              << before.name << std::endl;
+}
+
+// Benchmark groups, one per file
+void benchWriteMessage();
+void benchObjectTree();
+void benchIntrospection();
+void benchLogStream();
+
+#endif // BENCH_H
@@ -0,0 +1,36 @@
+// bench/BusBench.h
+
+#ifndef BUSBENCH_H
+#define BUSBENCH_H
+
+#include <string>
+#include <vector>
+#include "BLEManager.h"
+
+// Characteristics of the ESP32 peripheral, as in embeded/main.cpp
+static const char *const BENCH_CONFIG_UUID = "12345678-1234-5678-1234-56789abcdef1";
+static const char *const BENCH_LOG_UUID = "12345678-1234-5678-1234-56789abcdef2";
+static const char *const BENCH_MESSAGE_UUID = "12345678-1234-5678-1234-56789abcdef3";
+static const char *const BENCH_HANDSHAKE_RX_UUID = "12345678-1234-5678-1234-56789abcdef4";
+static const char *const BENCH_HANDSHAKE_TX_UUID = "12345678-1234-5678-1234-56789abcdef5";
+
+// Latency percentiles of a run
+struct LatencySummary
+{
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// Sorts latenciesMs
+LatencySummary summarizeLatencies(std::vector<double> &latenciesMs);
+
+// Connect to the device over poolSize D-Bus connections and discover its characteristics
+bool connectBenchDevice(BLEManager &bleManager, const std::string &macAddress, int poolSize = 1);
+
+// Benchmark groups that need BlueZ and a connected peripheral, one per file
+void benchRpc(const std::string &macAddress);
+void benchConfigUnderBulk(const std::string &macAddress);
+void benchWriteModes(const std::string &macAddress);
+
+#endif // BUSBENCH_H
@@ -0,0 +1,56 @@
+// bench/BusMain.cpp
+
+#include "BusBench.h"
+#include <algorithm>
+#include <iostream>
+
+// Percentiles by nearest rank
+LatencySummary summarizeLatencies(std::vector<double> &latenciesMs)
+{
+    LatencySummary summary;
+    if (latenciesMs.empty())
+    {
+        return summary;
+    }
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    summary.p50Ms = latenciesMs[(latenciesMs.size() - 1) * 50 / 100];
+    summary.p99Ms = latenciesMs[(latenciesMs.size() - 1) * 99 / 100];
+    summary.maxMs = latenciesMs.back();
+    return summary;
+}
+
+bool connectBenchDevice(BLEManager &bleManager, const std::string &macAddress, int poolSize)
+{
+    if (!bleManager.initialize(poolSize) || !bleManager.connectToDevice(macAddress) || !bleManager.listAllCharacteristics())
+    {
+        std::cerr << "Failed to connect to " << macAddress << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Round-trip benchmarks over BlueZ, against a connected peripheral
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <MAC address>" << std::endl;
+        return 2;
+    }
+    std::string macAddress = argv[1];
+
+    std::cout << std::fixed;
+    std::cout.precision(2);
+
+    std::cout << "RPC round trips" << std::endl;
+    benchRpc(macAddress);
+
+    std::cout << "Config writes next to a bulk read stream" << std::endl;
+    benchConfigUnderBulk(macAddress);
+
+    std::cout << "Message writes, fire-and-forget vs acknowledged" << std::endl;
+    benchWriteModes(macAddress);
+
+    return 0;
+}
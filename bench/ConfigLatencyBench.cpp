@@ -0,0 +1,82 @@
+// bench/ConfigLatencyBench.cpp
+
+#include "BusBench.h"
+#include "DeviceConfig.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+static const int CONFIG_WRITES = 200;
+static const int BULK_READERS = 2;
+
+// Acknowledged Config writes while BULK_READERS threads read the Log pipe
+// back to back. With one connection the writes queue behind the reads; a
+// larger pool moves the bulk traffic off the control connection.
+void benchConfigUnderBulk(const std::string &macAddress)
+{
+    DeviceConfig config;
+    config.setFrequencyMHz(433.0);
+    config.setModulation(Modulation::OOK);
+    config.setPowerDbm(10);
+    config.setRole(RadioRole::Transmitter);
+    std::string payload;
+    if (!config.encode(ConfigEncoding::LegacyAscii, payload))
+    {
+        return;
+    }
+
+    for (int poolSize : {1, 2, 4})
+    {
+        BLEManager bleManager;
+        if (!connectBenchDevice(bleManager, macAddress, poolSize) ||
+            !bleManager.setPipeType(BENCH_LOG_UUID, PipeType::Log))
+        {
+            return;
+        }
+
+        std::atomic<bool> stop(false);
+        std::atomic<unsigned long> bulkReads(0);
+        std::vector<std::thread> readers;
+        for (int i = 0; i < BULK_READERS; ++i)
+        {
+            readers.push_back(std::thread([&]()
+                                          {
+                std::string value;
+                while (!stop)
+                {
+                    if (bleManager.readFromPipe(BENCH_LOG_UUID, value))
+                    {
+                        bulkReads++;
+                    }
+                } }));
+        }
+
+        std::vector<double> latenciesMs;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < CONFIG_WRITES; ++i)
+        {
+            auto writeStart = std::chrono::steady_clock::now();
+            if (bleManager.writeToPipe(BENCH_CONFIG_UUID, payload, WriteMode::Acknowledged))
+            {
+                latenciesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - writeStart).count());
+            }
+        }
+        double elapsedS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        stop = true;
+        for (std::thread &reader : readers)
+        {
+            reader.join();
+        }
+
+        LatencySummary summary = summarizeLatencies(latenciesMs);
+        std::cout << "  pool of " << poolSize << ": Config p50 " << summary.p50Ms << " ms, p99 " << summary.p99Ms
+                  << " ms, bulk " << bulkReads / elapsedS << " reads/s";
+        if (latenciesMs.size() < static_cast<size_t>(CONFIG_WRITES))
+        {
+            std::cout << ", " << CONFIG_WRITES - latenciesMs.size() << " writes failed";
+        }
+        std::cout << std::endl;
+    }
+}
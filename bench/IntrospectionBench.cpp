@@ -0,0 +1,100 @@
+// bench/IntrospectionBench.cpp
+
+#include "Bench.h"
+#include "IntrospectionParser.h"
+#include "Utils.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Introspection XML of a BlueZ device: its own interfaces, then one child
+// node per GATT service
+static std::string buildDeviceXml(int serviceCount)
+{
+    std::string xml =
+        "<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
+        "\"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
+        "<node>"
+        "<interface name=\"org.freedesktop.DBus.Introspectable\">"
+        "<method name=\"Introspect\"><arg name=\"xml\" type=\"s\" direction=\"out\"/></method></interface>"
+        "<interface name=\"org.bluez.Device1\">"
+        "<method name=\"Disconnect\"></method><method name=\"Connect\"></method>"
+        "<method name=\"ConnectProfile\"><arg name=\"UUID\" type=\"s\" direction=\"in\"/></method>"
+        "<method name=\"Pair\"></method><method name=\"CancelPairing\"></method>"
+        "<property name=\"Address\" type=\"s\" access=\"read\"></property>"
+        "<property name=\"Name\" type=\"s\" access=\"read\"></property>"
+        "<property name=\"Connected\" type=\"b\" access=\"read\"></property>"
+        "<property name=\"ServicesResolved\" type=\"b\" access=\"read\"></property>"
+        "<property name=\"UUIDs\" type=\"as\" access=\"read\"></property>"
+        "</interface>"
+        "<interface name=\"org.freedesktop.DBus.Properties\">"
+        "<method name=\"Get\"><arg name=\"interface\" type=\"s\" direction=\"in\"/>"
+        "<arg name=\"name\" type=\"s\" direction=\"in\"/><arg name=\"value\" type=\"v\" direction=\"out\"/></method>"
+        "<signal name=\"PropertiesChanged\"><arg name=\"interface\" type=\"s\"/>"
+        "<arg name=\"changed_properties\" type=\"a{sv}\"/><arg name=\"invalidated_properties\" type=\"as\"/></signal>"
+        "</interface>";
+    for (int s = 0; s < serviceCount; ++s)
+    {
+        char node[48];
+        std::snprintf(node, sizeof(node), "<node name=\"service%04x\"/>", 0x10 * (s + 1));
+        xml += node;
+    }
+    return xml + "</node>";
+}
+
+// extractChildPaths as originally written: every '<node name="' is a child
+static std::vector<std::string> substringScan(const std::string &xmlData, const std::string &parentPath)
+{
+    std::vector<std::string> childPaths;
+    std::string searchStr = "<node name=\"";
+    size_t pos = 0;
+
+    while ((pos = xmlData.find(searchStr, pos)) != std::string::npos)
+    {
+        pos += searchStr.length();
+        size_t end = xmlData.find("\"", pos);
+        if (end == std::string::npos)
+            break;
+
+        childPaths.push_back(parentPath + "/" + xmlData.substr(pos, end - pos));
+        pos = end;
+    }
+    return childPaths;
+}
+
+// The original substring scan, the SAX parser on its own (no copies) and
+// Utils::extractChildPaths built on it, for a typical and a large device
+void benchIntrospection()
+{
+    const std::string devicePath = "/org/bluez/hci0/dev_AA_BB_CC_DD_EE_FF";
+    const int serviceCounts[] = {4, 64};
+    for (int serviceCount : serviceCounts)
+    {
+        std::string xml = buildDeviceXml(serviceCount);
+        std::string suffix = " (" + std::to_string(serviceCount) + " children)";
+
+        std::vector<StringView> rootInterfaces;
+        std::vector<IntrospectedNode> children;
+        auto scan = [&]()
+        {
+            benchSink = benchSink + substringScan(xml, devicePath).size();
+        };
+        auto parseNode = [&]()
+        {
+            rootInterfaces.clear();
+            children.clear();
+            IntrospectionParser::parseNode(xml.data(), xml.size(), rootInterfaces, children);
+            benchSink = benchSink + children.size();
+        };
+        auto extract = [&]()
+        {
+            benchSink = benchSink + Utils::extractChildPaths(xml, devicePath, "org.bluez.GattService1", "service").size();
+        };
+
+        BenchResult before = runBench("substring scan" + suffix, 100000, scan, xml.size());
+        BenchResult parsed = runBench("IntrospectionParser::parseNode" + suffix, 100000, parseNode, xml.size());
+        BenchResult extracted = runBench("Utils::extractChildPaths" + suffix, 100000, extract, xml.size());
+        printSpeedup(before, parsed);
+        printSpeedup(before, extracted);
+    }
+}
@@ -0,0 +1,89 @@
+// bench/LogStreamBench.cpp
+
+#include "Bench.h"
+#include "LogStreamParser.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Log stream of recordCount "timestamp|level|source|message" records of about 75 bytes
+static std::string buildLogStream(int recordCount)
+{
+    static const char *const levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    std::string stream;
+    for (int i = 0; i < recordCount; ++i)
+    {
+        stream += std::to_string(1700000000000LL + i * 17) + "|" + levels[i % 4] + "|sensor" +
+                  std::to_string(i % 8) + "|temperature=" + std::to_string(20 + i % 10) +
+                  ".5 humidity=41 battery=3.71V seq=" + std::to_string(i) + "\n";
+    }
+    return stream;
+}
+
+// Line splitting into owning strings, the straightforward allocating parser
+class AllocatingLogParser
+{
+public:
+    void feed(const char *data, size_t length)
+    {
+        pending.append(data, length);
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pending.find('\n', start)) != std::string::npos)
+        {
+            std::string line = pending.substr(start, newline - start);
+            std::vector<std::string> fields;
+            size_t fieldStart = 0;
+            for (int f = 0; f < 3; ++f)
+            {
+                size_t bar = line.find('|', fieldStart);
+                if (bar == std::string::npos)
+                    break;
+                fields.push_back(line.substr(fieldStart, bar - fieldStart));
+                fieldStart = bar + 1;
+            }
+            fields.push_back(line.substr(fieldStart));
+            records += fields.size() == 4;
+            start = newline + 1;
+        }
+        pending.erase(0, start);
+    }
+
+    unsigned long records = 0;
+
+private:
+    std::string pending;
+};
+
+// LogStreamParser against the allocating parser, with the stream cut in
+// notification-sized chunks (20 B default MTU, 244 B with DLE) and 4 KiB reads
+void benchLogStream()
+{
+    const std::string stream = buildLogStream(10000);
+    const size_t chunkSizes[] = {20, 244, 4096};
+    for (size_t chunkSize : chunkSizes)
+    {
+        std::string suffix = " (" + std::to_string(chunkSize) + " B chunks)";
+
+        auto feedAll = [&](auto &parser)
+        {
+            for (size_t offset = 0; offset < stream.size(); offset += chunkSize)
+            {
+                parser.feed(stream.data() + offset, std::min(chunkSize, stream.size() - offset));
+            }
+        };
+
+        AllocatingLogParser allocating;
+        unsigned long streamed = 0;
+        LogStreamParser parser([&](const LogRecord &record)
+                               { streamed += record.message.size; });
+
+        BenchResult before = runBench("allocating parser" + suffix, 20, [&]()
+                                      { feedAll(allocating); }, stream.size());
+        BenchResult after = runBench("LogStreamParser" + suffix, 20, [&]()
+                                     { feedAll(parser); }, stream.size());
+        printSpeedup(before, after);
+        std::cout << "  " << 10000 * 1e3 / after.nsPerOp << " M records/s" << std::endl;
+        benchSink = benchSink + allocating.records + streamed;
+    }
+}
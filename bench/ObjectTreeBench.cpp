@@ -0,0 +1,327 @@
+// bench/ObjectTreeBench.cpp
+
+#include "Bench.h"
+#include "ObjectTree.h"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Builds a GetManagedObjects reply shaped like BlueZ's
+class ManagedObjectsWriter
+{
+public:
+    explicit ManagedObjectsWriter(DBusMessage *msg)
+    {
+        dbus_message_iter_init_append(msg, &root);
+        dbus_message_iter_open_container(&root, DBUS_TYPE_ARRAY, "{oa{sa{sv}}}", &objects);
+    }
+
+    void beginObject(const std::string &path)
+    {
+        const char *value = path.c_str();
+        dbus_message_iter_open_container(&objects, DBUS_TYPE_DICT_ENTRY, nullptr, &object);
+        dbus_message_iter_append_basic(&object, DBUS_TYPE_OBJECT_PATH, &value);
+        dbus_message_iter_open_container(&object, DBUS_TYPE_ARRAY, "{sa{sv}}", &ifaces);
+
+        // BlueZ lists the standard interfaces on every object
+        beginInterface("org.freedesktop.DBus.Introspectable");
+        endInterface();
+        beginInterface("org.freedesktop.DBus.Properties");
+        endInterface();
+    }
+
+    void endObject()
+    {
+        dbus_message_iter_close_container(&object, &ifaces);
+        dbus_message_iter_close_container(&objects, &object);
+    }
+
+    void beginInterface(const char *name)
+    {
+        dbus_message_iter_open_container(&ifaces, DBUS_TYPE_DICT_ENTRY, nullptr, &iface);
+        dbus_message_iter_append_basic(&iface, DBUS_TYPE_STRING, &name);
+        dbus_message_iter_open_container(&iface, DBUS_TYPE_ARRAY, "{sv}", &props);
+    }
+
+    void endInterface()
+    {
+        dbus_message_iter_close_container(&iface, &props);
+        dbus_message_iter_close_container(&ifaces, &iface);
+    }
+
+    void addString(const char *name, const std::string &value, int type = DBUS_TYPE_STRING)
+    {
+        const char *str = value.c_str();
+        const char signature[] = {static_cast<char>(type), '\0'};
+        DBusMessageIter entry, variant;
+        openProperty(name, signature, entry, variant);
+        dbus_message_iter_append_basic(&variant, type, &str);
+        closeProperty(entry, variant);
+    }
+
+    void addBool(const char *name, bool value)
+    {
+        dbus_bool_t flag = value;
+        DBusMessageIter entry, variant;
+        openProperty(name, "b", entry, variant);
+        dbus_message_iter_append_basic(&variant, DBUS_TYPE_BOOLEAN, &flag);
+        closeProperty(entry, variant);
+    }
+
+    void addInt16(const char *name, dbus_int16_t value)
+    {
+        DBusMessageIter entry, variant;
+        openProperty(name, "n", entry, variant);
+        dbus_message_iter_append_basic(&variant, DBUS_TYPE_INT16, &value);
+        closeProperty(entry, variant);
+    }
+
+    void addStrings(const char *name, const std::vector<std::string> &values)
+    {
+        DBusMessageIter entry, variant, array;
+        openProperty(name, "as", entry, variant);
+        dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "s", &array);
+        for (const std::string &value : values)
+        {
+            const char *str = value.c_str();
+            dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &str);
+        }
+        dbus_message_iter_close_container(&variant, &array);
+        closeProperty(entry, variant);
+    }
+
+    void addBytes(const char *name, const std::vector<uint8_t> &values)
+    {
+        DBusMessageIter entry, variant, array;
+        openProperty(name, "ay", entry, variant);
+        dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "y", &array);
+        const uint8_t *data = values.data();
+        dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE, &data, static_cast<int>(values.size()));
+        dbus_message_iter_close_container(&variant, &array);
+        closeProperty(entry, variant);
+    }
+
+    void finish()
+    {
+        dbus_message_iter_close_container(&root, &objects);
+    }
+
+private:
+    void openProperty(const char *name, const char *signature, DBusMessageIter &entry, DBusMessageIter &variant)
+    {
+        dbus_message_iter_open_container(&props, DBUS_TYPE_DICT_ENTRY, nullptr, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &name);
+        dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, signature, &variant);
+    }
+
+    void closeProperty(DBusMessageIter &entry, DBusMessageIter &variant)
+    {
+        dbus_message_iter_close_container(&entry, &variant);
+        dbus_message_iter_close_container(&props, &entry);
+    }
+
+    DBusMessageIter root, objects, object, ifaces, iface, props;
+};
+
+// One adapter with deviceCount devices; every tenth device is connected and
+// resolved, with 3 services of 4 characteristics each. The reply goes through
+// marshal/demarshal so it is read like one received from the bus.
+static DBusMessage *buildManagedObjects(int deviceCount)
+{
+    DBusMessage *msg = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+    ManagedObjectsWriter writer(msg);
+
+    writer.beginObject("/org/bluez/hci0");
+    writer.beginInterface("org.bluez.Adapter1");
+    writer.addString("Address", "00:1A:7D:DA:71:13");
+    writer.addString("Name", "gateway");
+    writer.addBool("Powered", true);
+    writer.addBool("Discovering", true);
+    writer.addStrings("UUIDs", {"00001800-0000-1000-8000-00805f9b34fb", "00001801-0000-1000-8000-00805f9b34fb"});
+    writer.endInterface();
+    writer.endObject();
+
+    std::vector<std::string> charFlags = {"read", "write", "notify"};
+    std::vector<uint8_t> value(20, 0x42);
+    for (int d = 0; d < deviceCount; ++d)
+    {
+        char address[18];
+        std::snprintf(address, sizeof(address), "AA:BB:CC:%02X:%02X:%02X", (d >> 16) & 0xff, (d >> 8) & 0xff, d & 0xff);
+        std::string devicePath = "/org/bluez/hci0/dev_" + std::string(address);
+        for (char &c : devicePath)
+        {
+            if (c == ':')
+                c = '_';
+        }
+        bool connected = d % 10 == 0;
+
+        writer.beginObject(devicePath);
+        writer.beginInterface("org.bluez.Device1");
+        writer.addString("Address", address);
+        writer.addString("AddressType", "random");
+        writer.addString("Name", "sensor-" + std::to_string(d));
+        writer.addString("Alias", "sensor-" + std::to_string(d));
+        writer.addBool("Paired", false);
+        writer.addBool("Trusted", false);
+        writer.addBool("Connected", connected);
+        writer.addBool("ServicesResolved", connected);
+        writer.addString("Adapter", "/org/bluez/hci0", DBUS_TYPE_OBJECT_PATH);
+        writer.addInt16("RSSI", -60 - d % 30);
+        writer.addStrings("UUIDs", {"12345678-1234-5678-1234-56789abcdef0", "0000180f-0000-1000-8000-00805f9b34fb"});
+        writer.endInterface();
+        writer.endObject();
+
+        if (!connected)
+        {
+            continue;
+        }
+        for (int s = 0; s < 3; ++s)
+        {
+            char serviceName[16];
+            std::snprintf(serviceName, sizeof(serviceName), "/service%04x", 0x10 * (s + 1));
+            std::string servicePath = devicePath + serviceName;
+            writer.beginObject(servicePath);
+            writer.beginInterface("org.bluez.GattService1");
+            writer.addString("UUID", "12345678-1234-5678-1234-56789abcdef" + std::to_string(s));
+            writer.addString("Device", devicePath, DBUS_TYPE_OBJECT_PATH);
+            writer.addBool("Primary", true);
+            writer.endInterface();
+            writer.endObject();
+
+            for (int c = 0; c < 4; ++c)
+            {
+                char charName[16];
+                std::snprintf(charName, sizeof(charName), "/char%04x", 0x10 * (s + 1) + 2 * (c + 1));
+                writer.beginObject(servicePath + charName);
+                writer.beginInterface("org.bluez.GattCharacteristic1");
+                writer.addString("UUID", "12345678-1234-5678-1234-56789abcde" + std::to_string(10 + c));
+                writer.addString("Service", servicePath, DBUS_TYPE_OBJECT_PATH);
+                writer.addBytes("Value", value);
+                writer.addBool("Notifying", false);
+                writer.addStrings("Flags", charFlags);
+                writer.endInterface();
+                writer.endObject();
+            }
+        }
+    }
+    writer.finish();
+
+    // Round-trip through the wire format, like a captured reply
+    char *wire = nullptr;
+    int length = 0;
+    dbus_message_set_serial(msg, 2);
+    dbus_message_set_reply_serial(msg, 1);
+    dbus_message_marshal(msg, &wire, &length);
+    dbus_message_unref(msg);
+
+    DBusError error;
+    dbus_error_init(&error);
+    DBusMessage *reply = dbus_message_demarshal(wire, length, &error);
+    dbus_free(wire);
+    if (dbus_error_is_set(&error))
+    {
+        std::cerr << "Failed to demarshal the reply: " << error.message << std::endl;
+        dbus_error_free(&error);
+    }
+    return reply;
+}
+
+typedef std::map<std::string, std::map<std::string, std::map<std::string, std::string>>> GenericTree;
+
+// Decode the whole reply into owning containers, the shape a generic
+// a{oa{sa{sv}}} decoder produces (basic values as strings, containers skipped)
+static size_t decodeGeneric(DBusMessage *reply, GenericTree &tree)
+{
+    tree.clear();
+    DBusMessageIter iter, objectsIter;
+    dbus_message_iter_init(reply, &iter);
+    dbus_message_iter_recurse(&iter, &objectsIter);
+    while (dbus_message_iter_get_arg_type(&objectsIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter objectIter, ifacesIter;
+        dbus_message_iter_recurse(&objectsIter, &objectIter);
+        const char *path;
+        dbus_message_iter_get_basic(&objectIter, &path);
+        dbus_message_iter_next(&objectIter);
+        auto &object = tree[path];
+
+        dbus_message_iter_recurse(&objectIter, &ifacesIter);
+        while (dbus_message_iter_get_arg_type(&ifacesIter) == DBUS_TYPE_DICT_ENTRY)
+        {
+            DBusMessageIter ifaceIter, propsIter;
+            dbus_message_iter_recurse(&ifacesIter, &ifaceIter);
+            const char *ifaceName;
+            dbus_message_iter_get_basic(&ifaceIter, &ifaceName);
+            dbus_message_iter_next(&ifaceIter);
+            auto &iface = object[ifaceName];
+
+            dbus_message_iter_recurse(&ifaceIter, &propsIter);
+            while (dbus_message_iter_get_arg_type(&propsIter) == DBUS_TYPE_DICT_ENTRY)
+            {
+                DBusMessageIter propIter, variantIter;
+                dbus_message_iter_recurse(&propsIter, &propIter);
+                const char *name;
+                dbus_message_iter_get_basic(&propIter, &name);
+                dbus_message_iter_next(&propIter);
+                dbus_message_iter_recurse(&propIter, &variantIter);
+
+                std::string &value = iface[name];
+                int type = dbus_message_iter_get_arg_type(&variantIter);
+                if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH)
+                {
+                    const char *str;
+                    dbus_message_iter_get_basic(&variantIter, &str);
+                    value = str;
+                }
+                else if (type == DBUS_TYPE_BOOLEAN)
+                {
+                    dbus_bool_t flag;
+                    dbus_message_iter_get_basic(&variantIter, &flag);
+                    value = flag ? "true" : "false";
+                }
+                dbus_message_iter_next(&propsIter);
+            }
+            dbus_message_iter_next(&ifacesIter);
+        }
+        dbus_message_iter_next(&objectsIter);
+    }
+    return tree.size();
+}
+
+// ObjectTree::parse against a generic decode of the same reply, for a small
+// and a dense deployment
+void benchObjectTree()
+{
+    const int deviceCounts[] = {50, 1000};
+    for (int deviceCount : deviceCounts)
+    {
+        DBusMessage *reply = buildManagedObjects(deviceCount);
+        if (!reply)
+        {
+            std::cerr << "Failed to build the GetManagedObjects reply." << std::endl;
+            return;
+        }
+        std::string suffix = " (" + std::to_string(deviceCount) + " devices)";
+        size_t iterations = deviceCount > 100 ? 50 : 1000;
+
+        GenericTree generic;
+        ObjectTree tree;
+        auto decode = [&]()
+        {
+            benchSink = benchSink + decodeGeneric(reply, generic);
+        };
+        auto parse = [&]()
+        {
+            tree.parse(reply);
+            benchSink = benchSink + tree.getCharacteristics().size();
+        };
+
+        BenchResult before = runBench("generic decode" + suffix, iterations, decode);
+        BenchResult after = runBench("ObjectTree::parse" + suffix, iterations, parse);
+        printSpeedup(before, after);
+        std::cout << "  " << tree.getDevices().size() << " devices, " << tree.getCharacteristics().size()
+                  << " characteristics, arena " << tree.getArenaBytes() << " bytes" << std::endl;
+        dbus_message_unref(reply);
+    }
+}
@@ -0,0 +1,78 @@
+// bench/RpcBench.cpp
+
+#include "BusBench.h"
+#include "RpcClient.h"
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iostream>
+
+static const int RPC_REQUESTS = 200;
+static const int RPC_TIMEOUT_MS = 5000;
+
+// Requests through RpcClient with 1 to 16 in flight. Each round trip covers
+// the RX write, the TX notification, its correlation and the future completion.
+// The peripheral must echo the correlation id of each request on Handshake_TX.
+void benchRpc(const std::string &macAddress)
+{
+    BLEManager bleManager;
+    if (!connectBenchDevice(bleManager, macAddress))
+    {
+        return;
+    }
+
+    RpcClient rpc(bleManager, BENCH_HANDSHAKE_RX_UUID, BENCH_HANDSHAKE_TX_UUID);
+    if (!rpc.open())
+    {
+        return;
+    }
+
+    for (size_t inFlight : {1, 4, 16})
+    {
+        std::deque<std::future<RpcResult>> outstanding;
+        std::vector<double> latenciesMs;
+        int sent = 0;
+        int failed = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        while (sent < RPC_REQUESTS || !outstanding.empty())
+        {
+            while (sent < RPC_REQUESTS && outstanding.size() < inFlight)
+            {
+                outstanding.push_back(rpc.call("PING", RPC_TIMEOUT_MS));
+                sent++;
+            }
+
+            // Responses are mostly in order, collect those completed at the front
+            while (!outstanding.empty() &&
+                   outstanding.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                RpcResult result = outstanding.front().get();
+                outstanding.pop_front();
+                if (result.status == RpcStatus::Ok)
+                {
+                    latenciesMs.push_back(result.latencyMs);
+                }
+                else
+                {
+                    failed++;
+                }
+            }
+
+            if (!outstanding.empty() && (sent == RPC_REQUESTS || outstanding.size() == inFlight))
+            {
+                rpc.poll(RPC_TIMEOUT_MS);
+            }
+        }
+        double elapsedS = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        LatencySummary summary = summarizeLatencies(latenciesMs);
+        std::cout << "  " << inFlight << " in flight: " << latenciesMs.size() / elapsedS << " req/s, p50 "
+                  << summary.p50Ms << " ms, p99 " << summary.p99Ms << " ms";
+        if (failed > 0)
+        {
+            std::cout << ", " << failed << " failed";
+        }
+        std::cout << std::endl;
+    }
+}
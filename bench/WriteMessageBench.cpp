@@ -0,0 +1,90 @@
+// bench/WriteMessageBench.cpp
+
+#include "Bench.h"
+#include "DbusMarshal.h"
+#include <string>
+
+static const char *const CHAR_PATH = "/org/bluez/hci0/dev_AA_BB_CC_DD_EE_FF/service0010/char0012";
+
+// WriteValue built from scratch with one append call per byte, as originally written
+static DBusMessage *perByteWriteMessage(const std::string &value)
+{
+    DBusMessage *msg = dbus_message_new_method_call("org.bluez", CHAR_PATH, "org.bluez.GattCharacteristic1", "WriteValue");
+    DBusMessageIter args;
+    dbus_message_iter_init_append(msg, &args);
+
+    DBusMessageIter arrayIter;
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "y", &arrayIter);
+    for (const char &byte : value)
+    {
+        unsigned char byteData = static_cast<unsigned char>(byte);
+        dbus_message_iter_append_basic(&arrayIter, DBUS_TYPE_BYTE, &byteData);
+    }
+    dbus_message_iter_close_container(&args, &arrayIter);
+
+    DBusMessageIter dictIter;
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &dictIter);
+    dbus_message_iter_close_container(&args, &dictIter);
+    return msg;
+}
+
+// WriteValue built from scratch with the payload appended in one block
+static DBusMessage *freshWriteMessage(const std::string &value)
+{
+    DBusMessage *msg = dbus_message_new_method_call("org.bluez", CHAR_PATH, "org.bluez.GattCharacteristic1", "WriteValue");
+    DbusMarshal::ByteSpan payload = {reinterpret_cast<const uint8_t *>(value.data()), value.size()};
+    DbusMarshal::appendArgs(msg, payload, DbusMarshal::VariantDict());
+    return msg;
+}
+
+// WriteValue copied from a cached header template, as CharacteristicManager::buildWriteMessage does
+static DBusMessage *templateWriteMessage(DBusMessage *tmpl, const std::string &value)
+{
+    DBusMessage *msg = dbus_message_copy(tmpl);
+    DbusMarshal::ByteSpan payload = {reinterpret_cast<const uint8_t *>(value.data()), value.size()};
+    DbusMarshal::appendArgs(msg, payload, DbusMarshal::VariantDict());
+    return msg;
+}
+
+// The original per-byte WriteValue, a fresh message with a block payload and
+// a copy of a cached template, for a short control payload and a full
+// 244-byte ATT payload
+void benchWriteMessage()
+{
+    DBusMessage *tmpl = dbus_message_new_method_call("org.bluez", CHAR_PATH, "org.bluez.GattCharacteristic1", "WriteValue");
+
+    const size_t payloadSizes[] = {20, 244};
+    for (size_t size : payloadSizes)
+    {
+        std::string value(size, 'x');
+        std::string suffix = " (" + std::to_string(size) + " B)";
+
+        auto buildPerByte = [&]()
+        {
+            DBusMessage *msg = perByteWriteMessage(value);
+            benchSink = benchSink + dbus_message_get_serial(msg);
+            dbus_message_unref(msg);
+        };
+        auto buildFresh = [&]()
+        {
+            DBusMessage *msg = freshWriteMessage(value);
+            benchSink = benchSink + dbus_message_get_serial(msg);
+            dbus_message_unref(msg);
+        };
+        auto buildFromTemplate = [&]()
+        {
+            DBusMessage *msg = templateWriteMessage(tmpl, value);
+            benchSink = benchSink + dbus_message_get_serial(msg);
+            dbus_message_unref(msg);
+        };
+
+        BenchResult perByte = runBench("per-byte append" + suffix, 200000, buildPerByte);
+        BenchResult fresh = runBench("fresh message" + suffix, 200000, buildFresh);
+        BenchResult copied = runBench("template copy" + suffix, 200000, buildFromTemplate);
+        printSpeedup(perByte, fresh);
+        printSpeedup(fresh, copied);
+        printSpeedup(perByte, copied);
+    }
+
+    dbus_message_unref(tmpl);
+}
@@ -0,0 +1,58 @@
+// bench/WriteModeBench.cpp
+
+#include "Bench.h"
+#include "BusBench.h"
+#include <chrono>
+
+static const int MESSAGE_WRITES = 500;
+static const size_t MESSAGE_SIZE = 20; // One ATT payload at the default MTU
+
+// Time MESSAGE_WRITES writes to the Message pipe in one mode. Fire-and-forget
+// writes end with an acknowledged one: BlueZ answers it after handling the
+// writes queued before it, so both modes are timed until delivery.
+static BenchResult timeWrites(BLEManager &bleManager, const std::string &name, WriteMode mode)
+{
+    std::string message(MESSAGE_SIZE, 'm');
+    int failed = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < MESSAGE_WRITES; ++i)
+    {
+        if (!bleManager.writeToPipe(BENCH_MESSAGE_UUID, message, mode))
+        {
+            failed++;
+        }
+    }
+    if (mode == WriteMode::FireAndForget && !bleManager.writeToPipe(BENCH_MESSAGE_UUID, message, WriteMode::Acknowledged))
+    {
+        failed++;
+    }
+    double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    BenchResult result;
+    result.name = name;
+    result.nsPerOp = elapsedNs / MESSAGE_WRITES;
+    result.mbPerSecond = MESSAGE_SIZE * 1e3 / result.nsPerOp;
+    std::cout << "  " << name << ": " << result.nsPerOp / 1e3 << " us/write, " << 1e9 / result.nsPerOp << " writes/s";
+    if (failed > 0)
+    {
+        std::cout << ", " << failed << " failed";
+    }
+    std::cout << std::endl;
+    return result;
+}
+
+// Blocking acknowledged writes against fire-and-forget writes, which skip the round trip
+void benchWriteModes(const std::string &macAddress)
+{
+    BLEManager bleManager;
+    if (!connectBenchDevice(bleManager, macAddress) ||
+        !bleManager.setPipeType(BENCH_MESSAGE_UUID, PipeType::Message))
+    {
+        return;
+    }
+
+    BenchResult acknowledged = timeWrites(bleManager, "acknowledged", WriteMode::Acknowledged);
+    BenchResult fireAndForget = timeWrites(bleManager, "fire-and-forget", WriteMode::FireAndForget);
+    printSpeedup(acknowledged, fireAndForget);
+}
@@ -0,0 +1,26 @@
+// bench/main.cpp
+
+#include "Bench.h"
+
+volatile size_t benchSink = 0;
+
+// Micro-benchmarks of the framework paths that run without a bus
+int main()
+{
+    std::cout << std::fixed;
+    std::cout.precision(2);
+
+    std::cout << "WriteValue message construction" << std::endl;
+    benchWriteMessage();
+
+    std::cout << "GetManagedObjects parsing" << std::endl;
+    benchObjectTree();
+
+    std::cout << "Introspection child discovery" << std::endl;
+    benchIntrospection();
+
+    std::cout << "Log stream parsing" << std::endl;
+    benchLogStream();
+
+    return 0;
+}
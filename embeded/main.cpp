@@ -25,41 +25,49 @@ const std::string CHARACTERISTIC_HANDSHAKE_TX_UUID = "12345678-1234-5678-1234-56
 // Function Definitions
 // ----------------------
 
-// Function to initialize BLE and connect to ESP32
-bool initializeBLE(BLEManager &bleManager, const std::string &serviceUUID)
+// Function to bring up the ESP32 session: connect, discover, configure and handshake
+bool bringUpESP32(BLEManager &bleManager, const std::string &serviceUUID)
 {
-    std::cout << "Initializing BLE Manager..." << std::endl;
-    if (!bleManager.initialize())
-    {
-        std::cerr << "Failed to initialize BLE Manager." << std::endl;
-        return false;
-    }
+    std::cout << "Bringing up BLE session..." << std::endl;
 
-    std::cout << "Listing connected BLE devices..." << std::endl;
-    std::vector<BluetoothDevice> devices = bleManager.listConnectedDevices();
+    // Reuse the characteristic table of known devices across runs
+    bleManager.enableGattCache("gatt_cache.bin");
 
-    if (devices.empty())
+    // Radio settings, validated before anything is sent
+    DeviceConfig config;
+    config.setFrequencyMHz(433.0);
+    config.setModulation(Modulation::OOK);
+    config.setPowerDbm(10);
+    config.setRole(RadioRole::Transmitter);
+
+    // Current firmware still parses the ASCII format
+    std::string radioConfig;
+    if (!config.encode(ConfigEncoding::LegacyAscii, radioConfig))
     {
-        std::cerr << "No connected BLE devices found." << std::endl;
+        std::cerr << "Invalid radio configuration." << std::endl;
         return false;
     }
 
-    // Select the first connected device
-    BluetoothDevice selectedDevice = devices.front();
-    std::cout << "Selected Device: " << selectedDevice.name << " [" << selectedDevice.macAddress << "]" << std::endl;
+    BringUpPlan plan;
+    // Only discover the characteristics of our service
+    plan.filter.serviceUUIDs.insert(serviceUUID);
+    plan.configUUID = CHARACTERISTIC_CONFIG_UUID;
+    plan.configData = radioConfig;
+    plan.handshakeRxUUID = CHARACTERISTIC_HANDSHAKE_RX_UUID;
+    plan.handshakeTxUUID = CHARACTERISTIC_HANDSHAKE_TX_UUID;
+    plan.handshakeRequest = "Handshake_Request";
+    // Message and Log pipes are bulk streams, keep them off the control connection
+    plan.pipeTypes[CHARACTERISTIC_MESSAGE_UUID] = PipeType::Message;
+    plan.pipeTypes[CHARACTERISTIC_LOG_UUID] = PipeType::Log;
 
-    if (!bleManager.connectToDevice(selectedDevice.macAddress))
+    BringUpReport report;
+    if (!bleManager.bringUp(plan, report))
     {
-        std::cerr << "Failed to connect to the BLE device." << std::endl;
+        std::cerr << "Failed to bring up the BLE session." << std::endl;
         return false;
     }
 
-    std::cout << "Listing all characteristics..." << std::endl;
-    if (!bleManager.listAllCharacteristics())
-    {
-        std::cerr << "Failed to list characteristics." << std::endl;
-        return false;
-    }
+    std::cout << "Connected to " << report.deviceAddress << ", handshake response: " << report.handshakeResponse << std::endl;
 
     // **New Code: List All Characteristics with UUIDs and Paths**
     CharacteristicManager *charManager = bleManager.getCharacteristicManager();
@@ -83,66 +91,6 @@ bool initializeBLE(BLEManager &bleManager, const std::string &serviceUUID)
     return true;
 }
 
-// Function to configure ESP32 radio settings
-bool configureESP32(BLEManager &bleManager)
-{
-    std::cout << "Configuring ESP32 radio settings..." << std::endl;
-
-    // Define the configuration command in the expected format
-    std::string configCommand = "FREQ:433.0;MOD:OOK;PWR:10;ROLE:Transmitter;";
-
-    // Write the configuration command to the ESP32
-    if (!bleManager.writeToPipe(CHARACTERISTIC_CONFIG_UUID, configCommand))
-    {
-        std::cerr << "Failed to write configuration to ESP32." << std::endl;
-        return false;
-    }
-
-    std::cout << "Configuration command sent successfully." << std::endl;
-    return true;
-}
-
-// Function to perform handshake with ESP32
-bool performHandshake(BLEManager &bleManager)
-{
-    std::cout << "Performing handshake with ESP32..." << std::endl;
-
-    // Define the handshake message
-    std::string handshakeMessage = "Handshake_Request";
-
-    // Write the handshake message to Handshake_RX
-    if (!bleManager.writeToPipe(CHARACTERISTIC_HANDSHAKE_RX_UUID, handshakeMessage))
-    {
-        std::cerr << "Failed to send handshake message to ESP32." << std::endl;
-        return false;
-    }
-
-    std::cout << "Handshake message sent. Waiting for response..." << std::endl;
-
-    // Wait for handshake response (e.g., 5 seconds)
-    std::string response;
-    bool received = false;
-    for (int i = 0; i < 5; ++i)
-    {
-        if (bleManager.readFromPipe(CHARACTERISTIC_HANDSHAKE_TX_UUID, response))
-        {
-            std::cout << "Received Handshake Response: " << response << std::endl;
-            received = true;
-            break;
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
-
-    if (!received)
-    {
-        std::cerr << "Handshake response not received within timeout." << std::endl;
-        return false;
-    }
-
-    std::cout << "Handshake completed successfully." << std::endl;
-    return true;
-}
-
 // Function to send a message to ESP32
 bool sendMessage(BLEManager &bleManager, const std::string &message)
 {
@@ -168,24 +116,10 @@ int main()
 {
     BLEManager bleManager;
 
-    // Step 1: Initialize BLE and connect to ESP32
-    if (!initializeBLE(bleManager, SERVICE_UUID))
-    {
-        std::cerr << "BLE Initialization and connection failed." << std::endl;
-        return 1;
-    }
-
-    // Step 2: Configure ESP32 radio settings
-    if (!configureESP32(bleManager))
+    // Steps 1-3: Connect, configure and handshake with ESP32 as one pipeline
+    if (!bringUpESP32(bleManager, SERVICE_UUID))
     {
-        std::cerr << "ESP32 Configuration failed." << std::endl;
-        return 1;
-    }
-
-    // Step 3: Perform handshake
-    if (!performHandshake(bleManager))
-    {
-        std::cerr << "Handshake with ESP32 failed." << std::endl;
+        std::cerr << "BLE bring-up failed." << std::endl;
         return 1;
     }
 
@@ -197,6 +131,9 @@ int main()
         return 1;
     }
 
+    // Reconnect on its own if the ESP32 drops, reads fail fast meanwhile
+    bleManager.superviseLink(ReconnectPolicy());
+
     // Step 5: Listen for incoming log data by polling
     std::cout << "BLE Communication setup complete. Listening for logs..." << std::endl;
     int logCount = 0; // Count the number of log entries received
@@ -211,7 +148,7 @@ int main()
             logCount++; // Increment the log count
         }
 
-        std::this_thread::sleep_for(std::chrono::seconds(1)); // Poll every second
+        bleManager.processEvents(1000); // Poll every second, serving the link supervisor meanwhile
     }
 
     std::cout << "Received " << maxLogs << " logs. Exiting loop." << std::endl;
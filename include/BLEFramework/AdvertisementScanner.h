@@ -0,0 +1,162 @@
+// include/AdvertisementScanner.h
+
+#ifndef ADVERTISEMENTSCANNER_H
+#define ADVERTISEMENTSCANNER_H
+
+#include <dbus/dbus.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DbusConnection.h"
+
+// Adapter1.SetDiscoveryFilter options used while scanning
+struct ScanFilter
+{
+    std::set<std::string> serviceUUIDs; // Advertised service UUIDs, empty accepts every device
+    int16_t rssiThreshold = -127;       // dBm, weaker advertisements are dropped by BlueZ
+    bool duplicateData = true;          // Report every advertisement, not only changed data
+};
+
+// Telemetry of one device
+struct Advertisement
+{
+    std::string devicePath;
+    std::string macAddress;
+    int16_t rssi; // Last RSSI reported for the device
+    bool hasRssi;
+    bool dataChanged; // False when only the RSSI changed since the last delivery
+    std::map<uint16_t, std::vector<uint8_t>> manufacturerData; // By company identifier
+    std::map<std::string, std::vector<uint8_t>> serviceData;   // By service UUID
+    std::chrono::steady_clock::time_point receivedAt;
+};
+
+typedef std::function<void(const Advertisement &)> AdvertisementHandler;
+
+// Connectionless telemetry from advertisements.
+// Discovery runs on every powered adapter with an LE-only filter; the
+// ManufacturerData and ServiceData of Device1 objects (InterfacesAdded for
+// new devices, PropertiesChanged afterwards) are delivered to the handler.
+// No connection is made, so the number of devices is not bound by the
+// controller's connection limit. Handlers run from processEvents().
+//
+// With DuplicateData every advertisement is a signal, so an ingest stage sits
+// in front of the handler: payloads are hashed straight from the message and
+// only decoded when the hash of the device changed; repeats are dropped, and
+// RSSI-only changes are coalesced to one delivery per device and interval.
+class AdvertisementScanner
+{
+public:
+    explicit AdvertisementScanner(DbusConnection &dbusConn);
+    ~AdvertisementScanner();
+
+    // Set the discovery filter and start discovery on every powered adapter
+    bool start(const ScanFilter &filter, AdvertisementHandler handler);
+
+    // Stop discovery and clear the filter
+    void stop();
+
+    bool isScanning() const;
+
+    // Dispatch advertisements and due RSSI updates, waiting up to timeoutMs for new ones
+    bool processEvents(int timeoutMs);
+
+    // Minimum time between two deliveries of an unchanged payload with a new
+    // RSSI (default 1000 ms, 0 delivers every change, negative never does)
+    void setRssiUpdateInterval(int intervalMs);
+
+    // Forget devices that sent nothing for idleMs (default 60 s, 0 keeps them
+    // until BlueZ removes them), so rotating random addresses don't pile up
+    void setDeviceExpiry(int idleMs);
+
+    // Statistics
+    unsigned long getSignalCount() const;        // Device signals received
+    unsigned long getAdvertisementCount() const; // Delivered to the handler
+    unsigned long getSuppressedCount() const;    // Repeats and coalesced RSSI updates
+    size_t getDeviceCount() const;               // Devices that sent telemetry
+    unsigned long getExpiredCount() const;       // Devices forgotten (removed or idle)
+
+private:
+    AdvertisementScanner(const AdvertisementScanner &) = delete;
+    AdvertisementScanner &operator=(const AdvertisementScanner &) = delete;
+
+    struct DeviceState
+    {
+        std::string devicePath;
+        std::string macAddress;
+        uint64_t manufacturerHash = 0;
+        uint64_t serviceHash = 0;
+        bool hasManufacturerData = false;
+        bool hasServiceData = false;
+        int16_t rssi = 0;
+        bool hasRssi = false;
+        int16_t deliveredRssi = 0;
+        bool rssiPending = false; // Queued in rssiDue
+        std::chrono::steady_clock::time_point lastDelivery;
+        std::chrono::steady_clock::time_point lastSeen;
+        std::map<uint16_t, std::vector<uint8_t>> manufacturerData;
+        std::map<std::string, std::vector<uint8_t>> serviceData;
+    };
+
+    typedef std::pair<std::chrono::steady_clock::time_point, DeviceState *> RssiDue;
+
+    // A device appeared with its first advertisement
+    void onInterfacesAdded(DBusMessage *msg);
+
+    // Advertising data of a known device changed
+    void onPropertiesChanged(DBusMessage *msg);
+
+    // BlueZ dropped a device (e.g. its temporary object timed out)
+    void onInterfacesRemoved(DBusMessage *msg);
+
+    // Drop a device and its queued RSSI update, stateMutex must be held
+    typedef std::map<std::string, DeviceState, std::less<>>::iterator DeviceIterator;
+    void forgetDevice(DeviceIterator it);
+
+    // Forget the devices idle for longer than the expiry, at most once per sweep interval
+    void expireIdleDevices();
+
+    // Run one set of Device1 properties through the ingest stage
+    void ingest(const char *devicePath, DBusMessageIter *propsIter);
+
+    // Deliver the RSSI updates whose interval has passed
+    void flushRssiUpdates();
+
+    // Copy the device's current telemetry into an advertisement
+    static Advertisement snapshot(const DeviceState &state, bool dataChanged,
+                                  std::chrono::steady_clock::time_point now);
+
+    // Send the filter to one adapter (an empty filter clears it)
+    bool setDiscoveryFilter(const std::string &adapterPath, const ScanFilter *filter);
+
+    void removeSignalHandlers();
+
+    DbusConnection &dbusConnection;
+    AdvertisementHandler handler;
+    std::vector<std::string> scanningAdapters;
+    int addedSignalId;
+    int changedSignalId;
+    int removedSignalId;
+    int rssiIntervalMs;
+    int deviceExpiryMs;
+    std::chrono::steady_clock::time_point nextExpirySweep;
+
+    // By device path; std::less<> finds a path without building a std::string
+    std::map<std::string, DeviceState, std::less<>> devices;
+    std::priority_queue<RssiDue, std::vector<RssiDue>, std::greater<RssiDue>> rssiDue;
+
+    unsigned long signalCount;
+    unsigned long advertisementCount;
+    unsigned long suppressedCount;
+    size_t telemetryDeviceCount;
+    unsigned long expiredCount;
+    mutable std::mutex stateMutex;
+};
+
+#endif // ADVERTISEMENTSCANNER_H
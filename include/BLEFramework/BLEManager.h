@@ -6,11 +6,35 @@
 #include <string>
 #include <vector>
 #include <functional> // For std::function
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
 #include "BLETypes.h"
 #include "DbusConnection.h"
 #include "CharacteristicManager.h"
 #include "PipeManager.h" // Updated include
+#include "ObjectTree.h"
+#include "GattCache.h"
+#include "CircuitBreaker.h"
+#include "DeviceConfig.h"
 
+// Receives the values notified by the characteristic of a pipe
+typedef std::function<void(const std::string &value)> PipeNotifyHandler;
+
+// Notified when the supervised link changes state
+typedef std::function<void(LinkState state, const std::string &macAddress)> LinkStateHandler;
+
+// Threading: readFromPipe, writeToPipe, getReadStats and the breaker getters
+// may be called from several threads at once, and while another thread runs
+// processEvents(). Every other call (connecting, discovery, pipe setup,
+// subscriptions, polling, supervision, bring-up) must come from one thread
+// and must not overlap pipe calls. Signal handlers only run on the thread
+// holding the dispatch mutex of the D-Bus connection; pipe calls on other
+// threads leave the signals they receive queued for it.
 class BLEManager
 {
 public:
@@ -21,18 +45,74 @@ public:
     // Initialize BLE Manager
     bool initialize();
 
-    // Connect to a specific BLE device by MAC address
+    // Initialize BLE Manager with a pool of private D-Bus connections
+    bool initialize(int connectionPoolSize);
+
+    // Connect to a specific BLE device by MAC address. A device seen through
+    // several adapters is placed on the least-loaded one.
     bool connectToDevice(const std::string &macAddress);
 
-    // List all connected devices
+    // List all connected devices, across all adapters
     std::vector<BluetoothDevice> listConnectedDevices();
 
+    // Whether BlueZ reports the device connected on any adapter (one GetManagedObjects)
+    bool isDeviceConnected(const std::string &macAddress);
+
+    // Connection count and observed throughput of every adapter
+    std::vector<AdapterStats> getAdapterStats();
+
+    // Throughput (bytes/s) that weighs as much as one connection when placing devices (default 2000)
+    void setPlacementBytesPerConnection(double bytesPerSecond);
+
     // Select a device (e.g., based on user input or automatically)
     bool selectDevice();
 
     // List all characteristics and populate uuidToPathMap
     bool listAllCharacteristics();
 
+    // List only the services/characteristics accepted by the filter
+    bool listAllCharacteristics(const DiscoveryFilter &filter);
+
+    // Wait until BlueZ reports ServicesResolved for the selected device, up to timeoutMs
+    bool waitForServicesResolved(int timeoutMs);
+
+    // Deadline used by discovery to wait for ServicesResolved (default 10 s)
+    void setServicesResolvedTimeout(int timeoutMs);
+
+    // Timeout of every blocking D-Bus call without a more specific one (default 5 s)
+    void setCallTimeout(int timeoutMs);
+
+    // Answer pipe reads with a Value notified through PropertiesChanged in the
+    // last ttlMs, without a ReadValue; 0 (default) always reads over the air
+    void setReadCacheTtl(int ttlMs);
+
+    // Over-the-air, coalesced and cached reads of the selected device
+    ReadStats getReadStats() const;
+
+    // Persist characteristic tables in filePath so reconnects can skip discovery
+    bool enableGattCache(const std::string &filePath);
+
+    // Fail calls to a device locally after policy.failureThreshold consecutive
+    // failures or timeouts (connect, pipe reads, acknowledged writes, fleet
+    // writes); one probe call per probeIntervalMs decides when they go out
+    // again, a fire-and-forget write used as the probe is sent acknowledged
+    void enableCircuitBreaker(const BreakerPolicy &policy);
+
+    // Closed for devices without failures or when no breaker is enabled
+    BreakerState getBreakerState(const std::string &macAddress) const;
+
+    // Close the breaker of a device, e.g. after it was power cycled
+    void resetBreaker(const std::string &macAddress);
+
+    std::vector<DeviceBreakerStats> getBreakerStats() const;
+
+    // Dispatch pending D-Bus signals (e.g. service changes) and apply layout
+    // changes, waiting up to timeoutMs
+    bool processEvents(int timeoutMs);
+
+    // Milliseconds from connectToDevice to the first successful write, -1 before it
+    double getTimeToFirstWriteMs() const;
+
     // Send a message to the BLE device
     bool sendMessage(const std::string &message);
 
@@ -54,26 +134,280 @@ public:
     // Getter for CharacteristicManager
     CharacteristicManager *getCharacteristicManager() const;
 
+    // Getter for DbusConnection
+    DbusConnection *getDbusConnection() const;
+
     // Methods for dynamic pipe management
     void registerPipe(const BLEPipe &pipe);
+    bool setPipeType(const std::string &uuid, PipeType type);
+    bool setPipeWriteMode(const std::string &uuid, WriteMode mode);
+    bool setPipeTimeout(const std::string &uuid, int timeoutMs);
     bool writeToPipe(const std::string &uuid, const std::string &data);
+    bool writeToPipe(const std::string &uuid, const std::string &data, WriteMode mode);
     bool readFromPipe(const std::string &uuid, std::string &data);
 
+    // Same with a timeout for this call (-1: the pipe's timeout) and a token
+    // another thread can cancel the call with
+    bool writeToPipe(const std::string &uuid, const std::string &data, WriteMode mode, int timeoutMs,
+                     const CancellationToken *cancel = nullptr);
+    bool readFromPipe(const std::string &uuid, std::string &data, int timeoutMs,
+                      const CancellationToken *cancel = nullptr);
+
+    // Write the same payload to the characteristic uuid of several connected
+    // devices at once. Every write is in flight concurrently and gets deadlineMs;
+    // returns when all devices answered or the deadline passed.
+    FleetWriteResult broadcastWrite(const std::vector<std::string> &macAddresses, const std::string &uuid,
+                                    const std::string &payload, int deadlineMs);
+
+    // Validate and encode a configuration, then write it to a Config pipe
+    bool writeConfig(const std::string &uuid, const DeviceConfig &config, ConfigEncoding encoding);
+
+    // Write only the keys that differ from the last config applied to the
+    // selected device, in one acknowledged write; nothing is sent when all match
+    bool applyConfig(const std::string &uuid, const DeviceConfig &config, ConfigEncoding encoding);
+
+    // Forget the last applied config of a device (e.g. after a firmware reset).
+    // Done by itself when the supervised link drops or the connection is released.
+    void invalidateAppliedConfig(const std::string &macAddress);
+
+    ConfigApplyStats getConfigApplyStats() const;
+
+    // Enable notifications on a pipe, returns a subscription id or -1
+    int subscribeToPipe(const std::string &uuid, PipeNotifyHandler handler);
+
+    // Remove a subscription and disable its notifications
+    void unsubscribeFromPipe(int subscriptionId);
+
+    // Watch Device1.Connected of the selected device. On a drop, calls in flight
+    // to the device fail at once and pipe calls fail fast; processEvents()
+    // reconnects with jittered exponential backoff, then restores the pipes and
+    // notify subscriptions.
+    bool superviseLink(const ReconnectPolicy &policy, LinkStateHandler handler = nullptr);
+
+    void stopSupervisingLink();
+
+    LinkState getLinkState() const;
+
+    // Poll the characteristic of a pipe that has no notify: options.window
+    // ReadValue calls stay in flight, processEvents() collects their values in
+    // the order they were sent into the pipe's receive queue. With autotune
+    // the window grows while the read rate keeps improving.
+    bool startPolling(const std::string &uuid, const PollingOptions &options);
+
+    // Stop polling a pipe, reads in flight are dropped; queued values stay
+    void stopPolling(const std::string &uuid);
+
+    // Take the oldest value from the receive queue of a pipe, false when it is empty
+    bool receiveFromPipe(const std::string &uuid, std::string &data);
+
+    std::vector<PollingStats> getPollingStats() const;
+
+    // Initialize, select, discover, configure and handshake in one pipeline.
+    // Independent steps overlap; report gets the timing of every stage.
+    bool bringUp(const BringUpPlan &plan, BringUpReport &report);
+
     // List all characteristics and pipes of the selected device
     bool initializeDevice();
 
     // Disconnect the BLE device
     void disconnectDevice();
 
+    // Disconnect a device at the BlueZ level to free its controller slot,
+    // clearing the selection when it is the selected device
+    bool releaseConnection(const std::string &macAddress);
+
 private:
     DbusConnection *dbusConn;
 
-    CharacteristicManager *charManager;
+    // Replaced by discovery; pipe calls keep the one they started with
+    std::shared_ptr<CharacteristicManager> charManager;
 
     PipeManager *pipeManager; // Updated to PipeManager
 
     std::string selectedDevicePath;
 
+    // Guards swaps of charManager, selectedDevicePath and selectedDeviceAddress,
+    // which only the thread driving the manager makes
+    mutable std::mutex deviceMutex;
+
+    // Select a device, or clear the selection with empty strings
+    void setSelectedDevice(const std::string &path, const std::string &address);
+
+    // Swap in a new characteristic manager (nullptr: none). The old one stops
+    // receiving signals at once and is freed when the last pipe call using it returns.
+    void replaceCharManager(CharacteristicManager *manager);
+
+    // Snapshot of the characteristic manager and address a pipe call works with
+    std::shared_ptr<CharacteristicManager> selectedDevice(std::string &macAddress) const;
+
+    // Last GetManagedObjects snapshot, reused across refreshes
+    ObjectTree objectTree;
+
+    // Register or update a pipe for every discovered characteristic
+    void registerDiscoveredPipes();
+
+    // Follow service changes of the selected device
+    void watchCharacteristicChanges();
+
+    // Update the pipe of a characteristic that appeared or disappeared
+    void onCharacteristicChanged(const std::string &uuid, const std::string &path);
+
+    // Placement score of an adapter in the current object tree snapshot
+    double adapterLoad(const std::string &adapterPath) const;
+
+    // Account pipe traffic to the adapter of the selected device
+    void recordTraffic(size_t bytes);
+
+    // Route PropertiesChanged(Value) of a characteristic to handler, returns the signal id
+    int addNotifyHandler(const std::string &charPath, PipeNotifyHandler handler);
+
+    // Follow Connected/ServicesResolved of the supervised device
+    void onLinkPropertiesChanged(DBusMessage *msg);
+
+    // The supervised link dropped
+    void onLinkLost();
+
+    // Start, finish or schedule a reconnect attempt, called from processEvents()
+    void serviceLink();
+
+    // A reconnect attempt failed, schedule the next one or give up
+    void onReconnectFailed(const std::string &reason);
+
+    // Rediscover and resubscribe after a reconnect
+    void restoreLink();
+
+    void setLinkState(LinkState state);
+
+    // Collect completed polled reads and refill every polling window, called from processEvents()
+    void servicePolling();
+
+    // Measure the read rate of a poller and move its window while autotuning
+    struct PipePoller;
+    void tunePollingWindow(PipePoller &poller);
+
+    // Give up the reads a poller has in flight
+    void cancelPolledReads(PipePoller &poller);
+
+    // Fail fast while the supervised link is not up
+    bool linkAvailable(const char *operation) const;
+
+    // Whether a call to the device may go out, false while its breaker is open
+    bool admitCall(const std::string &macAddress, const char *operation);
+
+    // Feed the outcome of an admitted call to the device's breaker
+    void recordCallOutcome(const std::string &macAddress, bool ok);
+
+    // Check the cached layout (or fill the cache) in the background
+    void startGattCacheCheck(uint64_t cachedHash, bool fromCache);
+
+    // Deliver pending signals and apply layout changes before a pipe call,
+    // skipped while another thread holds the dispatch mutex
+    void refreshCharacteristicsIfStale();
+
+    // Rerun discovery when the background check found a different layout.
+    // The dispatch mutex of dbusConn must be held: it serializes what signal
+    // handlers update (pipes, pollers, the link state) with rediscovery.
+    void applyLayoutChanges();
+
+    std::string selectedDeviceAddress;
+    std::string selectedAdapterPath;
+
+    // Pipe traffic per adapter path
+    struct AdapterTraffic
+    {
+        unsigned long long bytes;
+        unsigned long long windowBytes;
+        std::chrono::steady_clock::time_point windowStart;
+        double throughputBps;
+    };
+    std::map<std::string, AdapterTraffic> adapterTraffic;
+    mutable std::mutex trafficMutex; // Pipe calls may come from several threads
+    double placementBytesPerConnection;
+
+    // Filter of the last discovery, reused when rediscovering
+    DiscoveryFilter discoveryFilter;
+
+    GattCache *gattCache;
+    std::thread gattCacheThread;
+    std::atomic<bool> gattLayoutChanged;
+    bool gattCacheOutdated;
+
+    // Time-to-first-write report
+    std::chrono::steady_clock::time_point connectTime;
+    double timeToFirstWriteMs;
+    std::atomic<bool> warmStart;
+
+    int servicesResolvedTimeoutMs;
+
+    // Applied to the DbusConnection once it exists, -1 keeps its default
+    int callTimeoutMs;
+
+    CircuitBreaker *circuitBreaker; // nullptr while disabled
+
+    // Applied to every CharacteristicManager created, 0 disables the read cache
+    int readCacheTtlMs;
+
+    // Last config acknowledged by each device (by lowercase MAC address),
+    // dropped when the device disconnects since it may come back reset
+    std::map<std::string, DeviceConfig> appliedConfigs;
+    ConfigApplyStats configApplyStats;
+
+    // Notification subscriptions by id (the signal id of the first subscription)
+    struct PipeSubscription
+    {
+        std::string uuid;
+        std::string path;
+        PipeNotifyHandler handler;
+        int signalId;
+    };
+    std::map<int, PipeSubscription> pipeSubscriptions;
+
+    // Link supervision of the selected device
+    ReconnectPolicy reconnectPolicy;
+    LinkStateHandler linkStateHandler;
+    std::atomic<LinkState> linkState; // Read by pipe calls on any thread
+    int linkSignalId;
+    std::string supervisedPath;
+    std::string supervisedAddress;
+    int reconnectAttempts;
+    std::chrono::steady_clock::time_point nextReconnectAt;
+    std::chrono::steady_clock::time_point reconnectDeadline;
+    DBusPendingCall *reconnectCall;
+    std::mt19937 backoffRandom;
+
+    // Pipelined polling by lowercase pipe UUID
+    struct PolledRead
+    {
+        DBusPendingCall *pending;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    struct PipePoller
+    {
+        std::string uuid;
+        std::string path;
+        TrafficClass trafficClass;
+        PollingOptions options;
+        int timeoutMs;
+        int window;
+        std::deque<PolledRead> inFlight; // In send order
+        unsigned long completed;
+        unsigned long failed;
+        unsigned long dropped;
+        double readsPerSecond;
+
+        // Autotuner, one step per epoch
+        bool tuning;
+        int bestWindow;
+        double bestRate;
+        unsigned long epochReads;
+        std::chrono::steady_clock::time_point epochStart;
+    };
+    std::map<std::string, PipePoller> pollers;
+
+    // Received values by lowercase pipe UUID, filled by polling
+    std::map<std::string, std::deque<std::string>> receiveQueues;
+    mutable std::mutex receiveMutex; // receiveFromPipe may run on another thread
+
     // Additional private members as needed
 };
 
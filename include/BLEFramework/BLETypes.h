@@ -5,6 +5,7 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 
 // Struct to hold Bluetooth device information
@@ -14,6 +15,18 @@ struct BluetoothDevice
     std::string name;
     std::string macAddress; // Added MAC address
     bool connected;
+    std::string adapter; // Path of the adapter the device is seen through
+};
+
+// Load of one Bluetooth adapter (controller)
+struct AdapterStats
+{
+    std::string path;
+    std::string address;
+    bool powered;
+    unsigned int connectedDevices;      // All connections reported by BlueZ
+    unsigned long long bytesTransferred; // Pipe reads and writes made by this process
+    double throughputBps;               // Over the last complete one-second window
 };
 
 // Struct to hold BLE characteristic information
@@ -23,6 +36,14 @@ struct BLECharacteristic
     std::string uuid;
 };
 
+// Struct to restrict discovery to some services and characteristics
+// (an empty set means no restriction, UUIDs are case-insensitive)
+struct DiscoveryFilter
+{
+    std::set<std::string> serviceUUIDs;
+    std::set<std::string> characteristicUUIDs;
+};
+
 // Enum to define the type of data pipe
 enum class PipeType
 {
@@ -34,12 +55,154 @@ enum class PipeType
     // Add more types as needed
 };
 
+// Enum to define how writes are delivered
+enum class WriteMode
+{
+    Acknowledged,  // Wait for bluetoothd's method return
+    FireAndForget, // No-reply message, only local send failures are detected
+};
+
 // Struct to represent a generic BLE Pipe
 struct BLEPipe
 {
     std::string uuid;
     std::string path;
     PipeType type;
+    WriteMode writeMode = WriteMode::Acknowledged;
+    int timeoutMs = -1; // Of blocking reads and writes, -1 uses the default call timeout
+};
+
+// Steps of BLEManager::bringUp, an empty UUID skips the matching step
+struct BringUpPlan
+{
+    std::string macAddress; // Empty selects the first connected device
+    DiscoveryFilter filter;
+    std::string configUUID;
+    std::string configData;
+    std::string handshakeRxUUID;
+    std::string handshakeTxUUID;
+    std::string handshakeRequest;
+    std::map<std::string, PipeType> pipeTypes; // Applied while the handshake is in flight
+    int stageTimeoutMs = 5000;                 // Deadline of each D-Bus stage
+};
+
+// Timing of one bring-up stage, relative to the start of bringUp (stages may overlap)
+struct BringUpStage
+{
+    std::string name;
+    double startMs;
+    double durationMs;
+    bool ok;
+};
+
+// Result of BLEManager::bringUp
+struct BringUpReport
+{
+    std::vector<BringUpStage> stages;
+    std::string deviceAddress;
+    std::string handshakeResponse;
+    double totalMs = 0.0;
+};
+
+// State of the supervised link to the selected device
+enum class LinkState
+{
+    Unsupervised,
+    Up,
+    Down,       // Lost, waiting for the next reconnect attempt
+    Connecting, // Device1.Connect in flight
+    Restoring,  // Connected, waiting for ServicesResolved to restore pipes
+    GaveUp,     // ReconnectPolicy::maxAttempts reached
+};
+
+// Reconnect backoff: attempt n waits min(maxDelayMs, initialDelayMs * multiplier^n),
+// shortened by a random fraction of up to jitter so a fleet doesn't reconnect in lockstep
+struct ReconnectPolicy
+{
+    int initialDelayMs = 500;
+    int maxDelayMs = 30000;
+    double multiplier = 2.0;
+    double jitter = 0.5;        // 0..1
+    int maxAttempts = 0;        // 0 retries forever
+    int connectTimeoutMs = 10000;
+};
+
+// Where readCharacteristic got its values from
+struct ReadStats
+{
+    unsigned long overTheAir = 0; // ReadValue calls sent to the device
+    unsigned long coalesced = 0;  // Joined a ReadValue already in flight
+    unsigned long cacheHits = 0;  // Served from a recently notified Value
+};
+
+// Pipelined ReadValue polling of a characteristic without notify
+struct PollingOptions
+{
+    int window = 4;          // ReadValue calls kept in flight
+    bool autotune = false;   // Grow the window while throughput improves
+    int maxWindow = 16;      // Upper bound of the autotuner
+    int timeoutMs = -1;      // Of each ReadValue, -1 uses the pipe's timeout
+    size_t maxQueued = 1024; // Receive queue bound, the oldest values are dropped beyond it
+};
+
+// Polling statistics of one pipe
+struct PollingStats
+{
+    std::string uuid;
+    int window = 0;
+    bool tuning = false; // The autotuner hasn't settled yet
+    unsigned int inFlight = 0;
+    unsigned long completed = 0;
+    unsigned long failed = 0;  // Error replies and timeouts
+    unsigned long dropped = 0; // Values pushed out of a full receive queue
+    size_t queued = 0;
+    double readsPerSecond = 0.0; // Over the last measurement epoch
+};
+
+// Circuit breaker of one device
+enum class BreakerState
+{
+    Closed,   // Calls go out
+    Open,     // Calls fail locally until the next probe
+    HalfOpen, // One probe call is out, its outcome closes or reopens the breaker
+};
+
+struct BreakerPolicy
+{
+    int failureThreshold = 3;  // Consecutive failures or timeouts that open the breaker
+    int probeIntervalMs = 5000; // Time between probe calls while open
+};
+
+// Circuit breaker statistics of one device
+struct DeviceBreakerStats
+{
+    std::string macAddress;
+    BreakerState state = BreakerState::Closed;
+    int consecutiveFailures = 0;
+    unsigned long trips = 0;    // Times the breaker opened from closed
+    unsigned long rejected = 0; // Calls failed locally
+    unsigned long probes = 0;
+    double openForMs = 0.0;     // Since the breaker opened, 0 while closed
+};
+
+// Outcome of a fleet write on one device
+enum class FleetWriteStatus
+{
+    Succeeded,
+    Failed,   // Error reply, or device/characteristic not found
+    TimedOut, // No reply before the deadline
+    Rejected, // Not sent, the device's circuit breaker is open
+};
+
+// Aggregated result of BLEManager::broadcastWrite
+struct FleetWriteResult
+{
+    std::map<std::string, FleetWriteStatus> devices; // By MAC address
+    unsigned int succeeded = 0;
+    unsigned int failed = 0;
+    unsigned int timedOut = 0;
+    unsigned int rejected = 0;
+    double elapsedMs = 0.0;
 };
 
 #endif // BLETYPES_H
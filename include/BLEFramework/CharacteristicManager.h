@@ -4,11 +4,27 @@
 #define CHARACTERISTICMANAGER_H
 
 #include <dbus/dbus.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <map>
 #include "BLETypes.h"
+#include "DbusConnection.h"
 
-class DbusConnection; // Forward declaration
+// Notified when a characteristic appears (path set) or disappears (path empty)
+typedef std::function<void(const std::string &uuid, const std::string &path)> CharacteristicChangeHandler;
+
+// Guards the ReadValue a read sends over the air: admit is asked before it goes
+// out (false fails the read locally), outcome gets its result unless cancelled.
+// Reads answered by the cache or by a ReadValue already in flight call neither.
+struct ReadCallGuard
+{
+    std::function<bool()> admit;
+    std::function<void(bool ok)> outcome;
+};
 
 class CharacteristicManager
 {
@@ -19,19 +35,136 @@ public:
     // List all characteristics and populate uuidToPathMap
     bool listAllCharacteristics();
 
-    // Write to a characteristic
-    bool writeCharacteristic(const std::string &charPath, const std::string &value);
+    // List the characteristics accepted by the filter; other services are
+    // pruned before any per-characteristic call
+    bool listAllCharacteristics(const DiscoveryFilter &filter);
+
+    // Use a known UUID to path table (e.g. from the GATT cache) instead of discovering it
+    void loadUuidToPathMap(const std::map<std::string, std::string> &table);
+
+    // Write to a characteristic. An acknowledged write waits up to timeoutMs
+    // (-1: the default call timeout) and gives up when cancel is cancelled.
+    bool writeCharacteristic(const std::string &charPath, const std::string &value,
+                             TrafficClass trafficClass = TrafficClass::Control,
+                             WriteMode writeMode = WriteMode::Acknowledged,
+                             int timeoutMs = -1, const CancellationToken *cancel = nullptr);
+
+    // Start a WriteValue and return without waiting for its reply (see DbusConnection::finishCall)
+    DBusPendingCall *writeCharacteristicAsync(const std::string &charPath, const std::string &value, int timeoutMs,
+                                              TrafficClass trafficClass = TrafficClass::Control);
+
+    // Enable notifications, new values then arrive as PropertiesChanged signals
+    bool startNotify(const std::string &charPath);
+
+    // Start a StartNotify call without waiting for its reply
+    DBusPendingCall *startNotifyAsync(const std::string &charPath, int timeoutMs);
 
-    // Read from a characteristic
-    bool readCharacteristic(const std::string &charPath, std::string &value);
+    // Disable notifications
+    bool stopNotify(const std::string &charPath);
+
+    // Read from a characteristic, with the same timeout and cancellation as a
+    // write. Concurrent reads of one characteristic share a single ReadValue:
+    // later callers wait for the call in flight and get its result.
+    bool readCharacteristic(const std::string &charPath, std::string &value,
+                            TrafficClass trafficClass = TrafficClass::Control,
+                            int timeoutMs = -1, const CancellationToken *cancel = nullptr,
+                            const ReadCallGuard *guard = nullptr);
+
+    // Start a ReadValue and return without waiting for its reply; the value is
+    // read from the reply as bytes. Not coalesced with other reads.
+    DBusPendingCall *readCharacteristicAsync(const std::string &charPath, int timeoutMs,
+                                             TrafficClass trafficClass = TrafficClass::Control);
+
+    // Serve reads from Values notified through PropertiesChanged in the last
+    // ttlMs instead of reading over the air; 0 disables the cache
+    bool setReadCacheTtl(int ttlMs);
+
+    ReadStats getReadStats() const;
 
     // Getter for UUID to Path map
     std::map<std::string, std::string> getUuidToPathMap() const;
 
+    // Follow InterfacesAdded/InterfacesRemoved under the device and update the
+    // table in place, instead of rediscovering everything on a service change
+    bool watchChanges(CharacteristicChangeHandler handler);
+
+    // Stop following service changes
+    void stopWatchingChanges();
+
 private:
+    // Store a characteristic and its write template
+    void addCharacteristic(const std::string &uuid, const std::string &charPath);
+
+    // Signal handlers
+    void onInterfacesAdded(DBusMessage *msg);
+    void onInterfacesRemoved(DBusMessage *msg);
+
+    // Send a ReadValue and wait for its reply
+    bool readValue(const std::string &charPath, std::string &value, TrafficClass trafficClass,
+                   int timeoutMs, const CancellationToken *cancel);
+
+    // Wait for the result of a read another caller has in flight, readMutex must be held by lock
+    struct ReadFlight;
+    bool joinRead(std::unique_lock<std::mutex> &lock, const std::shared_ptr<ReadFlight> &flight,
+                  std::string &value, int timeoutMs, const CancellationToken *cancel);
+
+    // Cache a Value notified through PropertiesChanged
+    void onValueChanged(DBusMessage *msg);
+
+    // Build a WriteValue message without payload, from the cached template when available
+    DBusMessage *newWriteMessage(const std::string &charPath) const;
+
+    // Build a complete WriteValue message for value
+    DBusMessage *buildWriteMessage(const std::string &charPath, const std::string &value) const;
+
+    // Cache the WriteValue header template of a discovered characteristic
+    void cacheWriteTemplate(const std::string &charPath);
+
+    // Release all cached templates
+    void clearWriteTemplates();
+
     DbusConnection &dbusConnection;
     std::string devicePath;
     std::map<std::string, std::string> uuidToPathMap;
+
+    // Characteristic path to pre-built WriteValue header
+    std::map<std::string, DBusMessage *> writeTemplates;
+
+    // Guards uuidToPathMap and writeTemplates, which signal handlers update
+    mutable std::mutex tableMutex;
+
+    // Filter of the last discovery, applied to characteristics added later
+    DiscoveryFilter activeFilter;
+
+    // Service path to lowercase UUID, for services seen so far
+    std::map<std::string, std::string> serviceUuids;
+
+    CharacteristicChangeHandler changeHandler;
+    int addedSignalId;
+    int removedSignalId;
+
+    // ReadValue in flight for a characteristic, shared with the callers that join it
+    struct ReadFlight
+    {
+        bool done = false;
+        bool ok = false;
+        std::string value;
+    };
+
+    struct CachedValue
+    {
+        std::string value;
+        std::chrono::steady_clock::time_point receivedAt;
+    };
+
+    // Guards readFlights, valueCache and readStats
+    mutable std::mutex readMutex;
+    std::condition_variable readDone;
+    std::map<std::string, std::shared_ptr<ReadFlight>> readFlights; // By characteristic path
+    std::map<std::string, CachedValue> valueCache;                  // By characteristic path
+    int readCacheTtlMs;
+    int valueSignalId;
+    ReadStats readStats;
 };
 
 #endif // CHARACTERISTICMANAGER_H
@@ -0,0 +1,59 @@
+// include/CircuitBreaker.h
+
+#ifndef CIRCUITBREAKER_H
+#define CIRCUITBREAKER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BLETypes.h"
+
+// Per-device circuit breakers, by MAC address.
+// After failureThreshold consecutive failures a device's breaker opens and
+// its calls fail locally instead of waiting on bluetoothd. Every
+// probeIntervalMs one call is let through as a probe: success closes the
+// breaker, failure keeps it open for another interval.
+class CircuitBreaker
+{
+public:
+    explicit CircuitBreaker(const BreakerPolicy &policy_);
+    ~CircuitBreaker();
+
+    // Whether a call to the device may go out; every call allowed must be
+    // followed by recordSuccess or recordFailure
+    bool allowCall(const std::string &macAddress);
+
+    void recordSuccess(const std::string &macAddress);
+    void recordFailure(const std::string &macAddress);
+
+    BreakerState getState(const std::string &macAddress) const;
+
+    // Close the breaker of a device, e.g. after it was power cycled
+    void reset(const std::string &macAddress);
+
+    std::vector<DeviceBreakerStats> getStats() const;
+
+private:
+    struct Breaker
+    {
+        std::string macAddress;
+        BreakerState state = BreakerState::Closed;
+        int consecutiveFailures = 0;
+        unsigned long trips = 0;
+        unsigned long rejected = 0;
+        unsigned long probes = 0;
+        std::chrono::steady_clock::time_point openedAt;
+        std::chrono::steady_clock::time_point nextProbeAt;
+    };
+
+    // Breaker of a device, created closed; mutex must be held
+    Breaker &breakerFor(const std::string &macAddress);
+
+    BreakerPolicy policy;
+    std::map<std::string, Breaker> breakers; // By lowercase MAC address
+    mutable std::mutex mutex;
+};
+
+#endif // CIRCUITBREAKER_H
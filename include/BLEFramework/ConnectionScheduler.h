@@ -0,0 +1,121 @@
+// include/ConnectionScheduler.h
+
+#ifndef CONNECTIONSCHEDULER_H
+#define CONNECTIONSCHEDULER_H
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "BLEManager.h"
+
+// Order in which pooled devices get their turn
+enum class SchedulePolicy
+{
+    RoundRobin, // Pool order
+    Priority,   // Highest (time since last turn x priority) first, never-served devices before all
+};
+
+// Per-device view of the schedule
+struct ScheduledDeviceStatus
+{
+    std::string macAddress;
+    int priority;
+    bool connected;           // Connection held open by the scheduler
+    size_t queuedWrites;
+    unsigned long turns;      // Successful turns
+    unsigned long failures;   // Turns that failed to connect, discover or drain
+    double stalenessMs;       // Since the last successful turn, -1 before the first one
+    double lastTurnMs;        // Duration of the last turn, connect included
+    BreakerState breaker;     // Open breakers fail the turn without connecting
+};
+
+// Called during a device's turn, after its queued writes were sent; the
+// device is selected on the BLEManager, so pipes can be read here.
+// Returning false fails the turn.
+typedef std::function<bool(BLEManager &, const std::string &macAddress)> TurnHandler;
+
+// Rotates a pool of devices through the controller's limited connection slots.
+// A turn connects the device (connectToDevice), loads its characteristics
+// (from the GATT cache when the manager has one enabled, so reconnects skip
+// discovery), sends the writes queued for it and runs the turn handler.
+// At most maxConnections scheduled devices stay connected; when a new device
+// needs a slot, the one whose last successful turn is oldest is released.
+class ConnectionScheduler
+{
+public:
+    ConnectionScheduler(BLEManager &bleMgr, int maxConnections_);
+    ~ConnectionScheduler();
+
+    // Add a device to the pool (higher priority is served more often with SchedulePolicy::Priority)
+    void addDevice(const std::string &macAddress, int priority = 1);
+
+    // Remove a device from the pool, releasing its connection
+    void removeDevice(const std::string &macAddress);
+
+    void setPolicy(SchedulePolicy policy_);
+
+    // Restrict the characteristics loaded on each turn
+    void setDiscoveryFilter(const DiscoveryFilter &filter);
+
+    void setTurnHandler(TurnHandler handler);
+
+    // Write payload to pipe uuid at the device's next turn, writes are sent in order
+    bool queueWrite(const std::string &macAddress, const std::string &uuid, const std::string &payload);
+
+    // Serve the next device, returns false when its turn failed or the pool is empty
+    bool runTurn();
+
+    // Serve turns until durationMs has passed
+    void runFor(int durationMs);
+
+    // Release every connection held by the scheduler
+    void releaseAll();
+
+    std::vector<ScheduledDeviceStatus> getStatus() const;
+
+private:
+    struct QueuedWrite
+    {
+        std::string uuid;
+        std::string payload;
+    };
+
+    struct PooledDevice
+    {
+        std::string macAddress;
+        int priority;
+        bool connected;
+        std::deque<QueuedWrite> writes;
+        unsigned long turns;
+        unsigned long failures;
+        bool served;
+        bool attempted;
+        std::chrono::steady_clock::time_point lastServed;
+        std::chrono::steady_clock::time_point lastAttempt;
+        double lastTurnMs;
+    };
+
+    // Device whose turn is next, nullptr when the pool is empty
+    PooledDevice *nextDevice();
+
+    // Free a slot for device when all of them are in use
+    void makeRoom(const PooledDevice &device);
+
+    // Connect, load characteristics, drain writes, run the handler
+    bool serve(PooledDevice &device);
+
+    PooledDevice *find(const std::string &macAddress);
+
+    BLEManager &bleManager;
+    int maxConnections;
+    SchedulePolicy policy;
+    DiscoveryFilter discoveryFilter;
+    TurnHandler turnHandler;
+
+    std::vector<PooledDevice> pool;
+    size_t roundRobinCursor;
+};
+
+#endif // CONNECTIONSCHEDULER_H
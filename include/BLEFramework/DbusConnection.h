@@ -2,7 +2,41 @@
 #define DBUSCONNECTION_H
 
 #include <dbus/dbus.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <vector>
+
+// Traffic classes used to pick a connection from the pool
+enum class TrafficClass
+{
+    Control, // Discovery, Config and Handshake traffic
+    Bulk,    // Message and Log streams
+};
+
+// Callback for a subscribed signal, runs on the thread that dispatches it
+// while that thread holds DbusConnection::getDispatchMutex()
+typedef std::function<void(DBusMessage *)> SignalHandler;
+
+// Error name of a call given up through a CancellationToken
+static const char *const CALL_CANCELLED_ERROR = "org.bleframework.Error.Cancelled";
+
+// Lets another thread give up a blocking call; cancel() makes the call
+// return within a few milliseconds and drops its pending reply
+class CancellationToken
+{
+public:
+    CancellationToken() : cancelled(false) {}
+
+    void cancel() { cancelled = true; }
+    void reset() { cancelled = false; }
+    bool isCancelled() const { return cancelled; }
+
+private:
+    std::atomic<bool> cancelled;
+};
 
 class DbusConnection
 {
@@ -10,9 +44,23 @@ public:
     DbusConnection();
     ~DbusConnection();
 
+    // Connect using the shared system-bus connection
     bool initialize();
+
+    // Connect using poolSize private connections (1 keeps the shared connection).
+    // Connection 0 carries control traffic, bulk traffic is spread per device
+    // over the remaining ones.
+    bool initialize(int poolSize);
+
+    // Control connection
     DBusConnection *getConnection() const;
 
+    // Connection assigned to a traffic class for a given device
+    DBusConnection *getConnection(TrafficClass trafficClass, const std::string &devicePath) const;
+
+    // Number of connections in the pool
+    int getPoolSize() const;
+
     // New method declarations
     DBusMessage *createMethodCall(const std::string &busName,
                                   const std::string &objectPath,
@@ -21,8 +69,131 @@ public:
 
     DBusMessage *sendAndBlock(DBusMessage *msg);
 
+    // Block on a call on the control connection for up to timeoutMs (-1: the
+    // default call timeout); error is set on failure, as with libdbus
+    DBusMessage *sendAndBlock(DBusMessage *msg, int timeoutMs, DBusError *error);
+
+    // Timeout of blocking calls that don't set their own (default 5 s)
+    void setDefaultCallTimeout(int timeoutMs);
+    int getDefaultCallTimeout() const;
+
+    // Send a message marked no-reply without waiting for the round trip.
+    // Only local failures are detected (out of memory, connection closed):
+    // BlueZ sends no error reply to such messages, and the bus would drop it.
+    bool sendNoReply(DBusMessage *msg, DBusConnection *conn);
+
+    // Send a method call without waiting for its reply; several calls can be
+    // in flight at once. Returns nullptr on failure.
+    DBusPendingCall *sendWithReply(DBusMessage *msg, DBusConnection *conn, int timeoutMs);
+
+    // Wait for the reply of a pending call and release it. Returns the reply,
+    // or nullptr on an error reply or timeout (logged with the name of the call,
+    // errorName gets the D-Bus error, e.g. DBUS_ERROR_NO_REPLY on timeout).
+    DBusMessage *finishCall(DBusPendingCall *pending, const std::string &callName, std::string *errorName = nullptr);
+
+    // Send a method call and wait up to timeoutMs (-1: the default call timeout)
+    // for its reply, dispatching incoming messages meanwhile. Signals received
+    // while another thread holds the dispatch mutex are queued for that
+    // thread's next processEvents() or dispatchPending(). Fails early when
+    // abortCalls() hits the call's object path or cancel is cancelled;
+    // errorName gets the D-Bus error, DBUS_ERROR_NO_REPLY on timeout,
+    // CALL_CANCELLED_ERROR or the abort error.
+    DBusMessage *callAndWait(DBusMessage *msg, DBusConnection *conn, int timeoutMs,
+                             const std::string &callName, std::string *errorName = nullptr,
+                             const CancellationToken *cancel = nullptr);
+
+    // Give up a pending call and release it at once, a late reply is discarded
+    void cancelCall(DBusPendingCall *pending);
+
+    // Fail the calls of callAndWait in flight to pathPrefix or objects below it
+    void abortCalls(const std::string &pathPrefix, const std::string &errorName);
+
+    // Dispatch messages already received on every connection, without blocking
+    void dispatchPending();
+
+    // Held while signal handlers run, by processEvents(), dispatchPending() and
+    // a callAndWait() that finds it free. Hold it to keep handlers away from
+    // state they update; recursive, so handlers may make calls.
+    std::recursive_mutex &getDispatchMutex();
+
+    // Subscribe to a signal on the control connection. matchRule is added to
+    // the bus; the handler gets every signal with this interface and member.
+    // Returns an id for removeSignalHandler, or -1 on failure.
+    int addSignalHandler(const std::string &matchRule, const std::string &interfaceName,
+                         const std::string &memberName, SignalHandler handler);
+
+    // Unsubscribe a handler returned by addSignalHandler
+    void removeSignalHandler(int id);
+
+    // Wait up to timeoutMs for incoming messages and dispatch them
+    bool processEvents(int timeoutMs);
+
+    // Same, waiting on waitOn (e.g. the bulk connection replies are expected
+    // on); messages received on the other connections are dispatched after it
+    bool processEvents(int timeoutMs, DBusConnection *waitOn);
+
+    // Fire-and-forget statistics
+    unsigned long getNoReplySentCount() const;
+    unsigned long getNoReplyFailureCount() const; // Local send failures only
+
+    // Method call statistics
+    unsigned long getCallCount() const;      // Calls sent expecting a reply
+    unsigned long getTimeoutCount() const;   // Calls that got no reply in time
+    unsigned long getCancelledCount() const; // Calls given up by the caller
+    unsigned long getAbortedCount() const;   // Calls failed by abortCalls()
+
 private:
+    static DBusHandlerResult messageFilter(DBusConnection *, DBusMessage *msg, void *userData);
+
+    // Run the handlers subscribed to a signal, dispatchMutex must be held
+    void routeSignal(DBusMessage *msg);
+
+    // Route the signals queued while another thread held dispatchMutex, which must be held
+    void runDeferredSignals();
+
+    void installFilters();
+
     DBusConnection *connection;
+
+    // Extra private connections used for bulk traffic (empty when shared)
+    std::vector<DBusConnection *> bulkConnections;
+
+    bool privateConnections;
+
+    std::atomic<unsigned long> noReplySent;
+    std::atomic<unsigned long> noReplyFailed;
+
+    std::atomic<int> defaultCallTimeoutMs;
+    std::atomic<unsigned long> callCount;
+    std::atomic<unsigned long> timeoutCount;
+    std::atomic<unsigned long> cancelledCount;
+    std::atomic<unsigned long> abortedCount;
+
+    struct SignalSubscription
+    {
+        int id;
+        std::string matchRule;
+        std::string interfaceName;
+        std::string memberName;
+        SignalHandler handler;
+    };
+
+    std::vector<SignalSubscription> signalSubscriptions;
+    std::mutex signalMutex; // Guards signalSubscriptions and deferredSignals
+    int nextSignalId;
+
+    std::recursive_mutex dispatchMutex;
+    std::deque<DBusMessage *> deferredSignals; // Referenced, in arrival order
+
+    // Calls waiting in callAndWait, abortError is set by abortCalls
+    struct InFlightCall
+    {
+        std::string path;
+        std::string abortError;
+    };
+
+    std::vector<InFlightCall *> inFlightCalls;
+    std::mutex inFlightMutex;
 };
 
 #endif // DBUSCONNECTION_H
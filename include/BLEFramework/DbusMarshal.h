@@ -0,0 +1,838 @@
+// include/DbusMarshal.h
+
+#ifndef DBUSMARSHAL_H
+#define DBUSMARSHAL_H
+
+#include <dbus/dbus.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "DbusConnection.h"
+
+// Header-only typed marshaling on top of libdbus.
+// D-Bus signatures are derived from C++ types, and every type has its own
+// Codec. A reply is checked against the expected signature once, then decoded
+// as a straight walk without per-element type checks. Only variants are
+// inspected at runtime, since their contents are not part of the signature.
+namespace DbusMarshal
+{
+    // Bus name of every call made through this layer
+    static const char *const BUS_NAME = "org.bluez";
+
+    // D-Bus object path ('o')
+    struct ObjectPath
+    {
+        std::string value;
+    };
+
+    // Empty reply
+    struct Void
+    {
+    };
+
+    // Borrowed byte buffer, encoded as 'ay' without copying it into a vector
+    struct ByteSpan
+    {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    // Variant ('v') holding the subset of types BlueZ uses in properties
+    struct Variant
+    {
+        std::string signature;            // Signature of the contained value
+        bool boolean = false;             // b
+        int64_t integer = 0;              // y, n, q, i, u, x, t
+        double real = 0.0;                // d
+        std::string string;               // s, o, g
+        std::vector<uint8_t> bytes;       // ay
+        std::vector<std::string> strings; // as, ao
+
+        // Dictionaries of byte arrays (advertising data), other values are skipped
+        std::map<uint16_t, std::vector<uint8_t>> keyedBytes;    // a{qv}, e.g. ManufacturerData
+        std::map<std::string, std::vector<uint8_t>> namedBytes; // a{sv}, e.g. ServiceData
+    };
+
+    // Options dictionary (a{sv})
+    typedef std::map<std::string, Variant> VariantDict;
+
+    // Variant whose contents must have the signature of T
+    template <typename T>
+    struct TypedVariant
+    {
+        T value;
+    };
+
+    // ----------------------
+    // Signatures
+    // ----------------------
+
+    // Signature text of fixed length N, built at compile time
+    template <size_t N>
+    struct SignatureString
+    {
+        char chars[N + 1];
+
+        constexpr const char *c_str() const { return chars; }
+
+        bool operator==(const char *other) const { return other && std::strcmp(chars, other) == 0; }
+        bool operator!=(const char *other) const { return !(*this == other); }
+    };
+
+    // SignatureString of a string literal
+    template <size_t N>
+    constexpr SignatureString<N - 1> signatureOf(const char (&text)[N])
+    {
+        SignatureString<N - 1> out{};
+        for (size_t i = 0; i < N; ++i)
+        {
+            out.chars[i] = text[i];
+        }
+        return out;
+    }
+
+    template <size_t A, size_t B>
+    constexpr SignatureString<A + B> operator+(const SignatureString<A> &a, const SignatureString<B> &b)
+    {
+        SignatureString<A + B> out{};
+        for (size_t i = 0; i < A; ++i)
+        {
+            out.chars[i] = a.chars[i];
+        }
+        for (size_t i = 0; i <= B; ++i)
+        {
+            out.chars[A + i] = b.chars[i];
+        }
+        return out;
+    }
+
+    // Concatenation of any number of signatures
+    constexpr SignatureString<0> concatSignatures()
+    {
+        return SignatureString<0>{};
+    }
+
+    template <typename First, typename... Rest>
+    constexpr auto concatSignatures(const First &first, const Rest &...rest)
+    {
+        return first + concatSignatures(rest...);
+    }
+
+    // Unsupported types fail to compile here. get() is constexpr; callers keep
+    // the result in a static constexpr local so no signature is built at runtime.
+    template <typename T>
+    struct Signature;
+
+#define DBUSMARSHAL_SIGNATURE(Type, Sig)   \
+    template <>                             \
+    struct Signature<Type>                  \
+    {                                       \
+        static constexpr auto get()         \
+        {                                   \
+            return signatureOf(Sig);        \
+        }                                   \
+    };
+
+    DBUSMARSHAL_SIGNATURE(uint8_t, "y")
+    DBUSMARSHAL_SIGNATURE(bool, "b")
+    DBUSMARSHAL_SIGNATURE(int16_t, "n")
+    DBUSMARSHAL_SIGNATURE(uint16_t, "q")
+    DBUSMARSHAL_SIGNATURE(int32_t, "i")
+    DBUSMARSHAL_SIGNATURE(uint32_t, "u")
+    DBUSMARSHAL_SIGNATURE(int64_t, "x")
+    DBUSMARSHAL_SIGNATURE(uint64_t, "t")
+    DBUSMARSHAL_SIGNATURE(double, "d")
+    DBUSMARSHAL_SIGNATURE(std::string, "s")
+    DBUSMARSHAL_SIGNATURE(ObjectPath, "o")
+    DBUSMARSHAL_SIGNATURE(Variant, "v")
+    DBUSMARSHAL_SIGNATURE(ByteSpan, "ay")
+    DBUSMARSHAL_SIGNATURE(Void, "")
+
+#undef DBUSMARSHAL_SIGNATURE
+
+    template <typename T>
+    struct Signature<TypedVariant<T>>
+    {
+        static constexpr auto get()
+        {
+            return signatureOf("v");
+        }
+    };
+
+    template <typename T>
+    struct Signature<std::vector<T>>
+    {
+        static constexpr auto get()
+        {
+            return signatureOf("a") + Signature<T>::get();
+        }
+    };
+
+    template <typename K, typename V>
+    struct Signature<std::map<K, V>>
+    {
+        static constexpr auto get()
+        {
+            return signatureOf("a{") + Signature<K>::get() + Signature<V>::get() + signatureOf("}");
+        }
+    };
+
+    template <typename... Ts>
+    struct Signature<std::tuple<Ts...>>
+    {
+        static constexpr auto get()
+        {
+            return signatureOf("(") + concatSignatures(Signature<Ts>::get()...) + signatureOf(")");
+        }
+    };
+
+    // ----------------------
+    // Codecs
+    // ----------------------
+
+    // Encoder/decoder per type. read() assumes the signature was already checked.
+    template <typename T>
+    struct Codec;
+
+    // Fixed-size basic types map directly to libdbus
+    template <typename T, int DbusType>
+    struct BasicCodec
+    {
+        static void append(DBusMessageIter *iter, const T &value)
+        {
+            dbus_message_iter_append_basic(iter, DbusType, &value);
+        }
+
+        static bool read(DBusMessageIter *iter, T &value)
+        {
+            dbus_message_iter_get_basic(iter, &value);
+            return true;
+        }
+    };
+
+    template <>
+    struct Codec<uint8_t> : BasicCodec<uint8_t, DBUS_TYPE_BYTE>
+    {
+    };
+    template <>
+    struct Codec<int16_t> : BasicCodec<int16_t, DBUS_TYPE_INT16>
+    {
+    };
+    template <>
+    struct Codec<uint16_t> : BasicCodec<uint16_t, DBUS_TYPE_UINT16>
+    {
+    };
+    template <>
+    struct Codec<int32_t> : BasicCodec<int32_t, DBUS_TYPE_INT32>
+    {
+    };
+    template <>
+    struct Codec<uint32_t> : BasicCodec<uint32_t, DBUS_TYPE_UINT32>
+    {
+    };
+    template <>
+    struct Codec<int64_t> : BasicCodec<int64_t, DBUS_TYPE_INT64>
+    {
+    };
+    template <>
+    struct Codec<uint64_t> : BasicCodec<uint64_t, DBUS_TYPE_UINT64>
+    {
+    };
+    template <>
+    struct Codec<double> : BasicCodec<double, DBUS_TYPE_DOUBLE>
+    {
+    };
+
+    template <>
+    struct Codec<bool>
+    {
+        static void append(DBusMessageIter *iter, const bool &value)
+        {
+            dbus_bool_t b = value ? TRUE : FALSE;
+            dbus_message_iter_append_basic(iter, DBUS_TYPE_BOOLEAN, &b);
+        }
+
+        static bool read(DBusMessageIter *iter, bool &value)
+        {
+            dbus_bool_t b;
+            dbus_message_iter_get_basic(iter, &b);
+            value = b != FALSE;
+            return true;
+        }
+    };
+
+    template <>
+    struct Codec<std::string>
+    {
+        static void append(DBusMessageIter *iter, const std::string &value)
+        {
+            const char *str = value.c_str();
+            dbus_message_iter_append_basic(iter, DBUS_TYPE_STRING, &str);
+        }
+
+        static bool read(DBusMessageIter *iter, std::string &value)
+        {
+            const char *str;
+            dbus_message_iter_get_basic(iter, &str);
+            value.assign(str);
+            return true;
+        }
+    };
+
+    template <>
+    struct Codec<ObjectPath>
+    {
+        static void append(DBusMessageIter *iter, const ObjectPath &value)
+        {
+            const char *str = value.value.c_str();
+            dbus_message_iter_append_basic(iter, DBUS_TYPE_OBJECT_PATH, &str);
+        }
+
+        static bool read(DBusMessageIter *iter, ObjectPath &value)
+        {
+            const char *str;
+            dbus_message_iter_get_basic(iter, &str);
+            value.value.assign(str);
+            return true;
+        }
+    };
+
+    template <>
+    struct Codec<Void>
+    {
+        static bool read(DBusMessageIter *, Void &)
+        {
+            return true;
+        }
+    };
+
+    template <>
+    struct Codec<ByteSpan>
+    {
+        static void append(DBusMessageIter *iter, const ByteSpan &value)
+        {
+            DBusMessageIter arrayIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "y", &arrayIter);
+            dbus_message_iter_append_fixed_array(&arrayIter, DBUS_TYPE_BYTE, &value.data, static_cast<int>(value.size));
+            dbus_message_iter_close_container(iter, &arrayIter);
+        }
+    };
+
+    template <typename T>
+    struct Codec<std::vector<T>>
+    {
+        static void append(DBusMessageIter *iter, const std::vector<T> &value)
+        {
+            static constexpr auto elementSignature = Signature<T>::get();
+            DBusMessageIter arrayIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, elementSignature.c_str(), &arrayIter);
+            for (const T &element : value)
+            {
+                Codec<T>::append(&arrayIter, element);
+            }
+            dbus_message_iter_close_container(iter, &arrayIter);
+        }
+
+        static bool read(DBusMessageIter *iter, std::vector<T> &value)
+        {
+            DBusMessageIter arrayIter;
+            dbus_message_iter_recurse(iter, &arrayIter);
+            value.clear();
+            while (dbus_message_iter_get_arg_type(&arrayIter) != DBUS_TYPE_INVALID)
+            {
+                value.emplace_back();
+                if (!Codec<T>::read(&arrayIter, value.back()))
+                {
+                    return false;
+                }
+                dbus_message_iter_next(&arrayIter);
+            }
+            return true;
+        }
+    };
+
+    // Byte arrays are copied as one block
+    template <>
+    struct Codec<std::vector<uint8_t>>
+    {
+        static void append(DBusMessageIter *iter, const std::vector<uint8_t> &value)
+        {
+            ByteSpan span = {value.data(), value.size()};
+            Codec<ByteSpan>::append(iter, span);
+        }
+
+        static bool read(DBusMessageIter *iter, std::vector<uint8_t> &value)
+        {
+            DBusMessageIter arrayIter;
+            dbus_message_iter_recurse(iter, &arrayIter);
+            const uint8_t *data = nullptr;
+            int length = 0;
+            dbus_message_iter_get_fixed_array(&arrayIter, &data, &length);
+            value.assign(data, data + length);
+            return true;
+        }
+    };
+
+    template <typename K, typename V>
+    struct Codec<std::map<K, V>>
+    {
+        static void append(DBusMessageIter *iter, const std::map<K, V> &value)
+        {
+            static constexpr auto entrySignature = signatureOf("{") + Signature<K>::get() + Signature<V>::get() + signatureOf("}");
+            DBusMessageIter arrayIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, entrySignature.c_str(), &arrayIter);
+            for (const auto &entry : value)
+            {
+                DBusMessageIter entryIter;
+                dbus_message_iter_open_container(&arrayIter, DBUS_TYPE_DICT_ENTRY, nullptr, &entryIter);
+                Codec<K>::append(&entryIter, entry.first);
+                Codec<V>::append(&entryIter, entry.second);
+                dbus_message_iter_close_container(&arrayIter, &entryIter);
+            }
+            dbus_message_iter_close_container(iter, &arrayIter);
+        }
+
+        static bool read(DBusMessageIter *iter, std::map<K, V> &value)
+        {
+            DBusMessageIter arrayIter;
+            dbus_message_iter_recurse(iter, &arrayIter);
+            value.clear();
+            while (dbus_message_iter_get_arg_type(&arrayIter) != DBUS_TYPE_INVALID)
+            {
+                DBusMessageIter entryIter;
+                dbus_message_iter_recurse(&arrayIter, &entryIter);
+                K key;
+                Codec<K>::read(&entryIter, key);
+                dbus_message_iter_next(&entryIter);
+                if (!Codec<V>::read(&entryIter, value[key]))
+                {
+                    return false;
+                }
+                dbus_message_iter_next(&arrayIter);
+            }
+            return true;
+        }
+    };
+
+    template <typename... Ts>
+    struct Codec<std::tuple<Ts...>>
+    {
+        static void append(DBusMessageIter *iter, const std::tuple<Ts...> &value)
+        {
+            DBusMessageIter structIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, nullptr, &structIter);
+            appendElements(&structIter, value, std::index_sequence_for<Ts...>());
+            dbus_message_iter_close_container(iter, &structIter);
+        }
+
+        static bool read(DBusMessageIter *iter, std::tuple<Ts...> &value)
+        {
+            DBusMessageIter structIter;
+            dbus_message_iter_recurse(iter, &structIter);
+            return readElements(&structIter, value, std::index_sequence_for<Ts...>());
+        }
+
+    private:
+        template <size_t... I>
+        static void appendElements(DBusMessageIter *iter, const std::tuple<Ts...> &value, std::index_sequence<I...>)
+        {
+            int expand[] = {0, (Codec<Ts>::append(iter, std::get<I>(value)), 0)...};
+            (void)expand;
+        }
+
+        template <size_t... I>
+        static bool readElements(DBusMessageIter *iter, std::tuple<Ts...> &value, std::index_sequence<I...>)
+        {
+            bool ok = true;
+            int expand[] = {0, (ok = ok && Codec<Ts>::read(iter, std::get<I>(value)), dbus_message_iter_next(iter), 0)...};
+            (void)expand;
+            return ok;
+        }
+    };
+
+    // Variants carry their own signature, so their contents are checked here
+    template <>
+    struct Codec<Variant>
+    {
+        static void append(DBusMessageIter *iter, const Variant &value)
+        {
+            DBusMessageIter variantIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, value.signature.c_str(), &variantIter);
+            switch (value.signature.empty() ? DBUS_TYPE_INVALID : value.signature[0])
+            {
+            case DBUS_TYPE_BOOLEAN:
+                Codec<bool>::append(&variantIter, value.boolean);
+                break;
+            case DBUS_TYPE_BYTE:
+            {
+                uint8_t v = static_cast<uint8_t>(value.integer);
+                Codec<uint8_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_INT16:
+            {
+                int16_t v = static_cast<int16_t>(value.integer);
+                Codec<int16_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_UINT16:
+            {
+                uint16_t v = static_cast<uint16_t>(value.integer);
+                Codec<uint16_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_INT32:
+            {
+                int32_t v = static_cast<int32_t>(value.integer);
+                Codec<int32_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_UINT32:
+            {
+                uint32_t v = static_cast<uint32_t>(value.integer);
+                Codec<uint32_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_INT64:
+                Codec<int64_t>::append(&variantIter, value.integer);
+                break;
+            case DBUS_TYPE_UINT64:
+            {
+                uint64_t v = static_cast<uint64_t>(value.integer);
+                Codec<uint64_t>::append(&variantIter, v);
+                break;
+            }
+            case DBUS_TYPE_DOUBLE:
+                Codec<double>::append(&variantIter, value.real);
+                break;
+            case DBUS_TYPE_STRING:
+                Codec<std::string>::append(&variantIter, value.string);
+                break;
+            case DBUS_TYPE_OBJECT_PATH:
+                Codec<ObjectPath>::append(&variantIter, ObjectPath{value.string});
+                break;
+            case DBUS_TYPE_ARRAY:
+                if (value.signature == "ay")
+                {
+                    Codec<std::vector<uint8_t>>::append(&variantIter, value.bytes);
+                }
+                else if (value.signature == "as")
+                {
+                    Codec<std::vector<std::string>>::append(&variantIter, value.strings);
+                }
+                break;
+            default:
+                break;
+            }
+            dbus_message_iter_close_container(iter, &variantIter);
+        }
+
+        static bool read(DBusMessageIter *iter, Variant &value)
+        {
+            DBusMessageIter variantIter;
+            dbus_message_iter_recurse(iter, &variantIter);
+
+            char *signature = dbus_message_iter_get_signature(&variantIter);
+            value.signature = signature ? signature : "";
+            dbus_free(signature);
+
+            switch (dbus_message_iter_get_arg_type(&variantIter))
+            {
+            case DBUS_TYPE_BOOLEAN:
+                return Codec<bool>::read(&variantIter, value.boolean);
+            case DBUS_TYPE_BYTE:
+            {
+                uint8_t v;
+                Codec<uint8_t>::read(&variantIter, v);
+                value.integer = v;
+                return true;
+            }
+            case DBUS_TYPE_INT16:
+            {
+                int16_t v;
+                Codec<int16_t>::read(&variantIter, v);
+                value.integer = v;
+                return true;
+            }
+            case DBUS_TYPE_UINT16:
+            {
+                uint16_t v;
+                Codec<uint16_t>::read(&variantIter, v);
+                value.integer = v;
+                return true;
+            }
+            case DBUS_TYPE_INT32:
+            {
+                int32_t v;
+                Codec<int32_t>::read(&variantIter, v);
+                value.integer = v;
+                return true;
+            }
+            case DBUS_TYPE_UINT32:
+            {
+                uint32_t v;
+                Codec<uint32_t>::read(&variantIter, v);
+                value.integer = v;
+                return true;
+            }
+            case DBUS_TYPE_INT64:
+                return Codec<int64_t>::read(&variantIter, value.integer);
+            case DBUS_TYPE_UINT64:
+            {
+                uint64_t v;
+                Codec<uint64_t>::read(&variantIter, v);
+                value.integer = static_cast<int64_t>(v);
+                return true;
+            }
+            case DBUS_TYPE_DOUBLE:
+                return Codec<double>::read(&variantIter, value.real);
+            case DBUS_TYPE_STRING:
+            case DBUS_TYPE_OBJECT_PATH:
+            case DBUS_TYPE_SIGNATURE:
+            {
+                const char *str;
+                dbus_message_iter_get_basic(&variantIter, &str);
+                value.string.assign(str);
+                return true;
+            }
+            case DBUS_TYPE_ARRAY:
+                if (value.signature == "ay")
+                {
+                    return Codec<std::vector<uint8_t>>::read(&variantIter, value.bytes);
+                }
+                if (value.signature == "as" || value.signature == "ao")
+                {
+                    DBusMessageIter arrayIter;
+                    dbus_message_iter_recurse(&variantIter, &arrayIter);
+                    value.strings.clear();
+                    while (dbus_message_iter_get_arg_type(&arrayIter) != DBUS_TYPE_INVALID)
+                    {
+                        const char *str;
+                        dbus_message_iter_get_basic(&arrayIter, &str);
+                        value.strings.push_back(str);
+                        dbus_message_iter_next(&arrayIter);
+                    }
+                }
+                if (value.signature == "a{qv}" || value.signature == "a{sv}")
+                {
+                    return readByteDict(&variantIter, value);
+                }
+                // Other containers are kept as signature only
+                return true;
+            default:
+                return true;
+            }
+        }
+
+    private:
+        // a{qv} or a{sv} whose variants hold ay
+        static bool readByteDict(DBusMessageIter *iter, Variant &value)
+        {
+            value.keyedBytes.clear();
+            value.namedBytes.clear();
+
+            DBusMessageIter arrayIter;
+            dbus_message_iter_recurse(iter, &arrayIter);
+            while (dbus_message_iter_get_arg_type(&arrayIter) == DBUS_TYPE_DICT_ENTRY)
+            {
+                DBusMessageIter entryIter;
+                dbus_message_iter_recurse(&arrayIter, &entryIter);
+                int keyType = dbus_message_iter_get_arg_type(&entryIter);
+                uint16_t id = 0;
+                const char *name = nullptr;
+                if (keyType == DBUS_TYPE_UINT16)
+                {
+                    dbus_message_iter_get_basic(&entryIter, &id);
+                }
+                else
+                {
+                    dbus_message_iter_get_basic(&entryIter, &name);
+                }
+                dbus_message_iter_next(&entryIter);
+
+                DBusMessageIter dataIter;
+                dbus_message_iter_recurse(&entryIter, &dataIter);
+                if (dbus_message_iter_get_arg_type(&dataIter) == DBUS_TYPE_ARRAY &&
+                    dbus_message_iter_get_element_type(&dataIter) == DBUS_TYPE_BYTE)
+                {
+                    std::vector<uint8_t> &bytes = keyType == DBUS_TYPE_UINT16 ? value.keyedBytes[id] : value.namedBytes[name];
+                    if (!Codec<std::vector<uint8_t>>::read(&dataIter, bytes))
+                    {
+                        return false;
+                    }
+                }
+                dbus_message_iter_next(&arrayIter);
+            }
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct Codec<TypedVariant<T>>
+    {
+        static void append(DBusMessageIter *iter, const TypedVariant<T> &value)
+        {
+            static constexpr auto valueSignature = Signature<T>::get();
+            DBusMessageIter variantIter;
+            dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, valueSignature.c_str(), &variantIter);
+            Codec<T>::append(&variantIter, value.value);
+            dbus_message_iter_close_container(iter, &variantIter);
+        }
+
+        static bool read(DBusMessageIter *iter, TypedVariant<T> &value)
+        {
+            DBusMessageIter variantIter;
+            dbus_message_iter_recurse(iter, &variantIter);
+
+            static constexpr auto expected = Signature<T>::get();
+            char *signature = dbus_message_iter_get_signature(&variantIter);
+            bool matches = expected == signature;
+            if (!matches)
+            {
+                std::cerr << "[DbusMarshal] Unexpected variant signature '" << (signature ? signature : "")
+                          << "', expected '" << expected.c_str() << "'." << std::endl;
+            }
+            dbus_free(signature);
+
+            return matches && Codec<T>::read(&variantIter, value.value);
+        }
+    };
+
+    // ----------------------
+    // Messages
+    // ----------------------
+
+    inline void appendArgs(DBusMessageIter *)
+    {
+    }
+
+    template <typename T, typename... Rest>
+    void appendArgs(DBusMessageIter *iter, const T &value, const Rest &...rest)
+    {
+        Codec<T>::append(iter, value);
+        appendArgs(iter, rest...);
+    }
+
+    // Append arguments to a message, in order
+    template <typename... Args>
+    void appendArgs(DBusMessage *msg, const Args &...args)
+    {
+        DBusMessageIter iter;
+        dbus_message_iter_init_append(msg, &iter);
+        appendArgs(&iter, args...);
+    }
+
+    // Decode a reply after checking its signature once
+    template <typename Ret>
+    bool readReply(DBusMessage *reply, Ret &out)
+    {
+        static constexpr auto expected = Signature<Ret>::get();
+        const char *signature = dbus_message_get_signature(reply);
+        if (expected != signature)
+        {
+            std::cerr << "[DbusMarshal] Unexpected reply signature '" << signature
+                      << "', expected '" << expected.c_str() << "'." << std::endl;
+            return false;
+        }
+
+        DBusMessageIter iter;
+        dbus_message_iter_init(reply, &iter);
+        return Codec<Ret>::read(&iter, out);
+    }
+
+    // Decode all arguments of a message (e.g. a signal), checking the signature once
+    template <typename... Ts>
+    bool readArgs(DBusMessage *msg, Ts &...outs)
+    {
+        // Signature of the argument list, the tuple signature without its parentheses
+        static constexpr auto expected = concatSignatures(Signature<Ts>::get()...);
+        const char *signature = dbus_message_get_signature(msg);
+        if (expected != signature)
+        {
+            std::cerr << "[DbusMarshal] Unexpected message signature '" << signature
+                      << "', expected '" << expected.c_str() << "'." << std::endl;
+            return false;
+        }
+
+        DBusMessageIter iter;
+        dbus_message_iter_init(msg, &iter);
+        bool ok = true;
+        int expand[] = {0, (ok = ok && Codec<Ts>::read(&iter, outs), dbus_message_iter_next(&iter), 0)...};
+        (void)expand;
+        return ok;
+    }
+
+    // Build a BlueZ method call with its arguments, nullptr on failure
+    template <typename... Args>
+    DBusMessage *newCall(const std::string &path, const std::string &iface, const std::string &method,
+                         const Args &...args)
+    {
+        DBusMessage *msg = dbus_message_new_method_call(BUS_NAME, path.c_str(), iface.c_str(), method.c_str());
+        if (!msg)
+        {
+            std::cerr << "[DbusMarshal] Failed to create " << method << " message for path: " << path << "." << std::endl;
+            return nullptr;
+        }
+        appendArgs(msg, args...);
+        return msg;
+    }
+
+    // Decode the reply of a blocking call, logging err when there is none
+    template <typename Ret>
+    bool takeReply(DBusMessage *reply, DBusError &err, const std::string &path, const std::string &method, Ret &out)
+    {
+        if (!reply)
+        {
+            std::cerr << "[DbusMarshal] " << method << " call failed for " << path << ": "
+                      << (dbus_error_is_set(&err) ? err.message : "Unknown error.") << std::endl;
+            dbus_error_free(&err);
+            return false;
+        }
+
+        bool ok = readReply(reply, out);
+        dbus_message_unref(reply);
+        return ok;
+    }
+
+    // Call a BlueZ method and decode its reply into out. Bounded by timeoutMs
+    // (-1: the default call timeout of dbusConn) and counted in its call statistics.
+    template <typename Ret, typename... Args>
+    bool call(DbusConnection &dbusConn, int timeoutMs, const std::string &path, const std::string &iface,
+              const std::string &method, Ret &out, const Args &...args)
+    {
+        DBusMessage *msg = newCall(path, iface, method, args...);
+        if (!msg)
+        {
+            return false;
+        }
+
+        DBusError err;
+        dbus_error_init(&err);
+
+        DBusMessage *reply = dbusConn.sendAndBlock(msg, timeoutMs, &err);
+        dbus_message_unref(msg);
+        return takeReply(reply, err, path, method, out);
+    }
+
+    // Read a property through org.freedesktop.DBus.Properties.Get, bounded by
+    // timeoutMs (-1: the default call timeout of dbusConn)
+    template <typename T>
+    bool getProperty(DbusConnection &dbusConn, int timeoutMs, const std::string &path, const std::string &iface,
+                     const std::string &name, T &out)
+    {
+        TypedVariant<T> variant;
+        if (!call(dbusConn, timeoutMs, path, "org.freedesktop.DBus.Properties", "Get", variant, iface, name))
+        {
+            return false;
+        }
+        out = std::move(variant.value);
+        return true;
+    }
+}
+
+#endif // DBUSMARSHAL_H
@@ -0,0 +1,98 @@
+// include/DeviceConfig.h
+
+#ifndef DEVICECONFIG_H
+#define DEVICECONFIG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Largest payload of a single ATT write with the default MTU (23 - 3 bytes of header)
+static const size_t MAX_CONFIG_PAYLOAD = 20;
+
+// Configuration keys, the value is the TLV tag
+enum class ConfigKey : uint8_t
+{
+    Frequency = 1,  // kHz
+    Modulation = 2, // Modulation
+    Power = 3,      // dBm
+    Role = 4,       // RadioRole
+};
+
+static const size_t CONFIG_KEY_COUNT = 4;
+
+enum class Modulation : uint8_t
+{
+    OOK,
+    ASK,
+    FSK,
+    GFSK,
+    MSK,
+};
+
+enum class RadioRole : uint8_t
+{
+    Transmitter,
+    Receiver,
+};
+
+// Wire format of a configuration
+enum class ConfigEncoding
+{
+    Tlv,         // [tag][length][little-endian value] per key
+    LegacyAscii, // "FREQ:433.0;MOD:OOK;PWR:10;ROLE:Transmitter;" for old firmware
+};
+
+// Typed device configuration. Keys, units and ranges come from a compile-time
+// schema (see DeviceConfig.cpp); values are validated when they are set, so an
+// invalid configuration never reaches the device. Only keys that were set are
+// encoded.
+class DeviceConfig
+{
+public:
+    DeviceConfig();
+
+    // Typed setters, return false and keep the previous value when out of range
+    bool setFrequencyMHz(double frequencyMHz);
+    bool setModulation(Modulation modulation);
+    bool setPowerDbm(int powerDbm);
+    bool setRole(RadioRole role);
+
+    // Raw access in schema units (kHz, enum index, dBm)
+    bool set(ConfigKey key, int64_t value);
+    bool has(ConfigKey key) const;
+    int64_t get(ConfigKey key) const;
+    void unset(ConfigKey key);
+    bool empty() const;
+
+    // Number of keys that are set
+    size_t size() const;
+
+    // Keys set here that are missing from applied or have another value there
+    DeviceConfig changedFrom(const DeviceConfig &applied) const;
+
+    // Copy the keys set in other
+    void merge(const DeviceConfig &other);
+
+    // Encode the keys that are set. TLV payloads must fit in MAX_CONFIG_PAYLOAD;
+    // legacy ASCII relies on long writes.
+    bool encode(ConfigEncoding encoding, std::string &payload) const;
+
+    // Decode a TLV payload, rejecting unknown tags and out-of-range values
+    static bool decodeTlv(const std::string &payload, DeviceConfig &config);
+
+private:
+    uint32_t presentMask;
+    int64_t values[CONFIG_KEY_COUNT];
+};
+
+// Counters of BLEManager::applyConfig
+struct ConfigApplyStats
+{
+    unsigned long writesSent = 0;
+    unsigned long writesAvoided = 0; // Nothing changed since the last applied config
+    unsigned long keysSent = 0;
+    unsigned long keysSkipped = 0; // Unchanged keys left out of delta writes
+};
+
+#endif // DEVICECONFIG_H
@@ -0,0 +1,65 @@
+// include/GattCache.h
+
+#ifndef GATTCACHE_H
+#define GATTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One characteristic of a cached GATT layout
+struct CachedCharacteristic
+{
+    std::string uuid;
+    std::string path;
+    std::string serviceUuid;
+    uint32_t flags; // CharacteristicFlag bits
+};
+
+// Persistent GATT layout cache, memory-mapped from a file.
+// Each device (by MAC address) maps to a layout hash and its characteristic
+// table, so a reconnect can skip discovery while the layout is unchanged.
+// Every access holds an flock on the file, so several processes can share it.
+class GattCache
+{
+public:
+    explicit GattCache(const std::string &filePath);
+    ~GattCache();
+
+    // Map the cache file, creating it when missing
+    bool open();
+
+    // Copy the cached table of a device, returns false on a miss
+    bool lookup(const std::string &macAddress, uint64_t &layoutHash,
+                std::vector<CachedCharacteristic> &characteristics);
+
+    // Insert or replace the table of a device
+    bool store(const std::string &macAddress, uint64_t layoutHash,
+               const std::vector<CachedCharacteristic> &characteristics);
+
+    // Hash of the paths and UUIDs of a table, independent of its order
+    static uint64_t computeLayoutHash(const std::vector<CachedCharacteristic> &characteristics);
+
+private:
+    GattCache(const GattCache &) = delete;
+    GattCache &operator=(const GattCache &) = delete;
+
+    bool mapFile(size_t entryCapacity);
+    void unmapFile();
+
+    // Recreate an empty cache file
+    bool resetFile();
+
+    // Remap after another process grew or reset the file, false when it is invalid
+    bool syncMapping();
+
+    std::string filePath;
+    int fd;
+    void *mapping;
+    size_t mappingSize;
+    std::mutex cacheMutex;
+};
+
+#endif // GATTCACHE_H
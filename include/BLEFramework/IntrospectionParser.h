@@ -0,0 +1,56 @@
+// include/IntrospectionParser.h
+
+#ifndef INTROSPECTIONPARSER_H
+#define INTROSPECTIONPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Non-owning view into the introspection document
+struct StringView
+{
+    const char *data;
+    size_t size;
+
+    std::string str() const;
+    bool equals(const char *other) const;
+    bool startsWith(const char *prefix) const;
+};
+
+// Direct child of the introspected object with the interfaces it declares
+struct IntrospectedNode
+{
+    StringView name;
+    std::vector<StringView> interfaces; // Empty when the child is only declared by name
+};
+
+// Receives elements from IntrospectionParser::parse
+class IntrospectionHandler
+{
+public:
+    virtual ~IntrospectionHandler() {}
+
+    // Opening (or self-closing) tag with its "name" attribute, depth 0 is the root node
+    virtual void onStartElement(const StringView &tag, const StringView &name, int depth) = 0;
+
+    // Closing tag, also sent for self-closing tags
+    virtual void onEndElement(const StringView &tag, int depth) = 0;
+};
+
+// Single-pass SAX-style parser for D-Bus introspection XML.
+// It never copies the document: every view points into the caller's buffer,
+// which must outlive the results.
+class IntrospectionParser
+{
+public:
+    // Stream elements to the handler, returns false on malformed XML
+    static bool parse(const char *xml, size_t length, IntrospectionHandler &handler);
+
+    // Collect the interfaces of the root node and its direct children
+    static bool parseNode(const char *xml, size_t length,
+                          std::vector<StringView> &rootInterfaces,
+                          std::vector<IntrospectedNode> &children);
+};
+
+#endif // INTROSPECTIONPARSER_H
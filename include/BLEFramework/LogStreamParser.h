@@ -0,0 +1,64 @@
+// include/LogStreamParser.h
+
+#ifndef LOGSTREAMPARSER_H
+#define LOGSTREAMPARSER_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "IntrospectionParser.h" // StringView
+
+// One log record, every field points into the parser's input or its carry buffer
+// and is only valid during the callback
+struct LogRecord
+{
+    StringView timestamp;
+    StringView level;
+    StringView source;
+    StringView message;
+};
+
+typedef std::function<void(const LogRecord &)> LogRecordHandler;
+
+// Streaming parser for the Log pipe.
+// Records are "timestamp|level|source|message" terminated by '\n' (a trailing
+// '\r' is ignored, the message may contain '|'). Notifications can split a
+// record anywhere: complete records are emitted straight from the input, and
+// only the unfinished tail is copied into a carry buffer that is allocated
+// once. Newlines are found 16 bytes at a time with SSE2 when available.
+class LogStreamParser
+{
+public:
+    explicit LogStreamParser(LogRecordHandler handler_, size_t maxRecordLength_ = 4096);
+
+    // Parse the next chunk of the stream
+    void feed(const char *data, size_t length);
+
+    // Drop a partially received record (e.g. after a reconnect)
+    void reset();
+
+    // Statistics
+    unsigned long getRecordCount() const;
+    unsigned long getMalformedCount() const; // Fewer than four fields
+    unsigned long getOverflowCount() const;  // Longer than maxRecordLength, dropped
+    unsigned long long getByteCount() const;
+
+private:
+    // Split one record (without its newline) into fields and emit it
+    void emitRecord(const char *data, size_t length);
+
+    // Keep the unfinished tail of a chunk
+    void appendCarry(const char *data, size_t length);
+
+    LogRecordHandler handler;
+    size_t maxRecordLength;
+    std::vector<char> carry;
+    bool discarding; // Skipping the rest of an overlong record
+
+    unsigned long recordCount;
+    unsigned long malformedCount;
+    unsigned long overflowCount;
+    unsigned long long byteCount;
+};
+
+#endif // LOGSTREAMPARSER_H
@@ -0,0 +1,124 @@
+// include/ObjectTree.h
+
+#ifndef OBJECTTREE_H
+#define OBJECTTREE_H
+
+#include <dbus/dbus.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DbusConnection.h"
+
+// Bump allocator for the strings of one refresh, released in one shot
+class Arena
+{
+public:
+    explicit Arena(size_t blockSize = 16 * 1024);
+    ~Arena();
+
+    // Copy a NUL-terminated string into the arena
+    const char *copyString(const char *str);
+
+    // Drop everything allocated so far, keeping the first block for reuse
+    void reset();
+
+    // Bytes handed out since the last reset
+    size_t bytesUsed() const;
+
+private:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    char *allocate(size_t size);
+
+    std::vector<char *> blocks;
+    size_t blockSize;
+    size_t offset;   // Offset in the last block
+    size_t totalUsed;
+};
+
+// Characteristic flags from GattCharacteristic1.Flags
+enum CharacteristicFlag : uint32_t
+{
+    CHAR_FLAG_READ = 1u << 0,
+    CHAR_FLAG_WRITE = 1u << 1,
+    CHAR_FLAG_WRITE_WITHOUT_RESPONSE = 1u << 2,
+    CHAR_FLAG_NOTIFY = 1u << 3,
+    CHAR_FLAG_INDICATE = 1u << 4,
+};
+
+// Records below point into the tree's arena and stay valid until the next refresh
+
+struct ManagedAdapter
+{
+    const char *path;
+    const char *address;
+    bool powered;
+};
+
+struct ManagedDevice
+{
+    const char *path;
+    const char *adapter;
+    const char *address;
+    const char *name;
+    bool connected;
+    bool servicesResolved;
+};
+
+struct ManagedService
+{
+    const char *path;
+    const char *device;
+    const char *uuid;
+    bool primary;
+};
+
+struct ManagedCharacteristic
+{
+    const char *path;
+    const char *service;
+    const char *uuid;
+    uint32_t flags;
+};
+
+// Snapshot of the org.bluez object tree from ObjectManager.GetManagedObjects.
+// The a{oa{sa{sv}}} reply is walked once and only the Adapter1, Device1,
+// GattService1 and GattCharacteristic1 properties we use are copied out.
+class ObjectTree
+{
+public:
+    ObjectTree();
+    ~ObjectTree();
+
+    // Call GetManagedObjects on org.bluez and parse the reply, bounded by the default call timeout
+    bool refresh(DbusConnection &dbusConn);
+
+    // Parse a GetManagedObjects reply, replacing the previous snapshot
+    bool parse(DBusMessage *reply);
+
+    const std::vector<ManagedAdapter> &getAdapters() const;
+    const std::vector<ManagedDevice> &getDevices() const;
+    const std::vector<ManagedService> &getServices() const;
+    const std::vector<ManagedCharacteristic> &getCharacteristics() const;
+
+    // Bytes held by the arena for the current snapshot
+    size_t getArenaBytes() const;
+
+private:
+    void clear();
+
+    void parseAdapter(DBusMessageIter *propsIter, const char *path);
+    void parseDevice(DBusMessageIter *propsIter, const char *path);
+    void parseService(DBusMessageIter *propsIter, const char *path);
+    void parseCharacteristic(DBusMessageIter *propsIter, const char *path);
+
+    Arena arena;
+
+    std::vector<ManagedAdapter> adapters;
+    std::vector<ManagedDevice> devices;
+    std::vector<ManagedService> services;
+    std::vector<ManagedCharacteristic> characteristics;
+};
+
+#endif // OBJECTTREE_H
@@ -5,9 +5,11 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include <vector>
 #include "BLETypes.h"
 
+// Registry of the pipes by UUID, safe to use from several threads
 class PipeManager
 {
 public:
@@ -20,6 +22,21 @@ public:
     // Remove a pipe by UUID
     bool removePipeByUUID(const std::string &uuid);
 
+    // Change the type of a pipe by UUID
+    bool setPipeType(const std::string &uuid, PipeType type);
+
+    // Change the default write mode of a pipe by UUID
+    bool setPipeWriteMode(const std::string &uuid, WriteMode mode);
+
+    // Change the default timeout of blocking calls on a pipe by UUID
+    bool setPipeTimeout(const std::string &uuid, int timeoutMs);
+
+    // Change the path of a pipe by UUID
+    bool setPipePath(const std::string &uuid, const std::string &path);
+
+    // Check whether a pipe is registered
+    bool hasPipe(const std::string &uuid) const;
+
     // Get a pipe by UUID
     BLEPipe getPipeByUUID(const std::string &uuid) const;
 
@@ -29,6 +46,7 @@ public:
 private:
     // Map of UUID to BLEPipe
     std::map<std::string, BLEPipe> pipes;
+    mutable std::mutex pipesMutex;
 };
 
 #endif // PIPEMANAGER_H
@@ -0,0 +1,104 @@
+// include/RpcClient.h
+
+#ifndef RPCCLIENT_H
+#define RPCCLIENT_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include "BLEManager.h"
+
+// Outcome of a request
+enum class RpcStatus
+{
+    Ok,
+    Timeout,    // No response before the deadline
+    SendFailed, // The request could not be written
+    Cancelled,  // The client was closed with the request in flight
+};
+
+// Result of a request, latencyMs is the round trip from write to response
+struct RpcResult
+{
+    RpcStatus status;
+    std::string response;
+    double latencyMs;
+};
+
+typedef std::function<void(const RpcResult &)> RpcCallback;
+
+// Request/response calls over the Handshake_RX/TX characteristics.
+// Every frame starts with a decimal correlation id and ':' ("17:GET_STATUS").
+// Requests are written to RX, responses are notified on TX with the id of
+// their request, so any number of requests can be in flight. Callbacks and
+// futures are completed from poll(), which also expires requests past their
+// deadline.
+class RpcClient
+{
+public:
+    RpcClient(BLEManager &bleMgr, const std::string &rxUUID_, const std::string &txUUID_);
+    ~RpcClient();
+
+    // Subscribe to the TX notifications
+    bool open();
+
+    // Unsubscribe and cancel the requests in flight
+    void close();
+
+    // Send a request, callback gets the response or the failure. Returns the correlation id, 0 on failure.
+    uint32_t call(const std::string &payload, int timeoutMs, RpcCallback callback);
+
+    // Send a request and get its result as a future (completed by poll())
+    std::future<RpcResult> call(const std::string &payload, int timeoutMs);
+
+    // Send a request and poll until its result is known
+    RpcResult callSync(const std::string &payload, int timeoutMs);
+
+    // Dispatch notifications and expire requests, waiting up to timeoutMs for new ones
+    void poll(int timeoutMs);
+
+    // Number of requests in flight
+    size_t getPendingCount() const;
+
+    // Round-trip statistics of answered requests
+    unsigned long getCompletedCount() const;
+    unsigned long getTimeoutCount() const;
+    unsigned long getUnmatchedCount() const; // Notifications without a pending request
+    double getAverageLatencyMs() const;
+    double getMaxLatencyMs() const;
+
+private:
+    struct PendingRequest
+    {
+        RpcCallback callback;
+        std::chrono::steady_clock::time_point sentAt;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    // Match a TX notification to its request
+    void onNotification(const std::string &value);
+
+    // Fail the requests whose deadline has passed
+    void expireRequests();
+
+    BLEManager &bleManager;
+    std::string rxUUID;
+    std::string txUUID;
+    int subscriptionId;
+
+    std::map<uint32_t, PendingRequest> pending;
+    mutable std::mutex pendingMutex;
+    uint32_t nextId;
+
+    unsigned long completedCount;
+    unsigned long timeoutCount;
+    unsigned long unmatchedCount;
+    double totalLatencyMs;
+    double maxLatencyMs;
+};
+
+#endif // RPCCLIENT_H
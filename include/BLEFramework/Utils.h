@@ -2,6 +2,7 @@
 #define UTILS_H
 
 #include <string>
+#include <set>
 #include <vector>
 #include "DbusConnection.h" // Include the DbusConnection header
 #include "BLETypes.h"
@@ -11,7 +12,15 @@ class Utils
 public:
     static BluetoothDevice parseBluetoothDevice(const std::string &objectPath, DbusConnection *dbusConn);
     static std::vector<std::string> extractChildPaths(const std::string &xmlData, const std::string &parentPath);
+
+    // Direct children implementing iface; children that declare no interfaces
+    // are kept when their name starts with namePrefix
+    static std::vector<std::string> extractChildPaths(const std::string &xmlData, const std::string &parentPath,
+                                                      const char *iface, const char *namePrefix);
     static std::string toLower(const std::string &str);
+
+    // Case-insensitive UUID match against a filter set, an empty set matches everything
+    static bool matchesUuidFilter(const std::set<std::string> &filter, const std::string &uuid);
 };
 
 #endif // UTILS_H
@@ -0,0 +1,647 @@
+// src/AdvertisementScanner.cpp
+
+#include "AdvertisementScanner.h"
+#include "DbusMarshal.h"
+#include "ObjectTree.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// "/org/bluez/hci0/dev_AA_BB_CC_DD_EE_FF" -> "AA:BB:CC:DD:EE:FF"
+static std::string addressFromPath(const std::string &devicePath)
+{
+    size_t pos = devicePath.rfind("/dev_");
+    if (pos == std::string::npos)
+    {
+        return "";
+    }
+    std::string address = devicePath.substr(pos + 5);
+    std::replace(address.begin(), address.end(), '_', ':');
+    return address;
+}
+
+// Idle devices are looked for at most this often, the sweep walks every device
+static const int EXPIRY_SWEEP_INTERVAL_MS = 1000;
+
+static const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// Hash an a{qv} or a{sv} of byte arrays in place, without copying the data
+static bool hashByteDict(DBusMessageIter *variantIter, uint64_t &hash)
+{
+    DBusMessageIter dictIter;
+    dbus_message_iter_recurse(variantIter, &dictIter);
+    if (dbus_message_iter_get_arg_type(&dictIter) != DBUS_TYPE_ARRAY ||
+        dbus_message_iter_get_element_type(&dictIter) != DBUS_TYPE_DICT_ENTRY)
+    {
+        return false;
+    }
+
+    hash = FNV_OFFSET;
+    DBusMessageIter entriesIter;
+    dbus_message_iter_recurse(&dictIter, &entriesIter);
+    while (dbus_message_iter_get_arg_type(&entriesIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter entryIter;
+        dbus_message_iter_recurse(&entriesIter, &entryIter);
+        if (dbus_message_iter_get_arg_type(&entryIter) == DBUS_TYPE_UINT16)
+        {
+            uint16_t id;
+            dbus_message_iter_get_basic(&entryIter, &id);
+            hash = hashBytes(hash, &id, sizeof(id));
+        }
+        else if (dbus_message_iter_get_arg_type(&entryIter) == DBUS_TYPE_STRING)
+        {
+            const char *name;
+            dbus_message_iter_get_basic(&entryIter, &name);
+            hash = hashBytes(hash, name, std::strlen(name) + 1);
+        }
+        dbus_message_iter_next(&entryIter);
+
+        DBusMessageIter valueIter;
+        dbus_message_iter_recurse(&entryIter, &valueIter);
+        if (dbus_message_iter_get_arg_type(&valueIter) == DBUS_TYPE_ARRAY &&
+            dbus_message_iter_get_element_type(&valueIter) == DBUS_TYPE_BYTE)
+        {
+            DBusMessageIter bytesIter;
+            dbus_message_iter_recurse(&valueIter, &bytesIter);
+            const uint8_t *data = nullptr;
+            int length = 0;
+            dbus_message_iter_get_fixed_array(&bytesIter, &data, &length);
+            hash = hashBytes(hash, &length, sizeof(length));
+            hash = hashBytes(hash, data, length);
+        }
+        dbus_message_iter_next(&entriesIter);
+    }
+    return true;
+}
+
+// Advertising fields found in one set of Device1 properties
+struct PropertyScan
+{
+    const char *address = nullptr;
+    bool hasRssi = false;
+    int16_t rssi = 0;
+    bool hasManufacturerData = false;
+    uint64_t manufacturerHash = 0;
+    DBusMessageIter manufacturerIter; // At the variant, decoded only when the hash changed
+    bool hasServiceData = false;
+    uint64_t serviceHash = 0;
+    DBusMessageIter serviceIter;
+};
+
+// Walk an a{sv} of Device1 properties once, skipping everything else
+static void scanProperties(DBusMessageIter *propsIter, PropertyScan &scan)
+{
+    DBusMessageIter entriesIter;
+    dbus_message_iter_recurse(propsIter, &entriesIter);
+    while (dbus_message_iter_get_arg_type(&entriesIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter entryIter;
+        dbus_message_iter_recurse(&entriesIter, &entryIter);
+        const char *name;
+        dbus_message_iter_get_basic(&entryIter, &name);
+        dbus_message_iter_next(&entryIter);
+
+        DBusMessageIter valueIter;
+        dbus_message_iter_recurse(&entryIter, &valueIter);
+        int type = dbus_message_iter_get_arg_type(&valueIter);
+
+        if (std::strcmp(name, "RSSI") == 0 && type == DBUS_TYPE_INT16)
+        {
+            dbus_message_iter_get_basic(&valueIter, &scan.rssi);
+            scan.hasRssi = true;
+        }
+        else if (std::strcmp(name, "ManufacturerData") == 0)
+        {
+            scan.manufacturerIter = entryIter;
+            scan.hasManufacturerData = hashByteDict(&entryIter, scan.manufacturerHash);
+        }
+        else if (std::strcmp(name, "ServiceData") == 0)
+        {
+            scan.serviceIter = entryIter;
+            scan.hasServiceData = hashByteDict(&entryIter, scan.serviceHash);
+        }
+        else if (std::strcmp(name, "Address") == 0 && type == DBUS_TYPE_STRING)
+        {
+            dbus_message_iter_get_basic(&valueIter, &scan.address);
+        }
+        dbus_message_iter_next(&entriesIter);
+    }
+}
+
+AdvertisementScanner::AdvertisementScanner(DbusConnection &dbusConn)
+    : dbusConnection(dbusConn), addedSignalId(-1), changedSignalId(-1), removedSignalId(-1), rssiIntervalMs(1000),
+      deviceExpiryMs(60000), signalCount(0), advertisementCount(0), suppressedCount(0), telemetryDeviceCount(0),
+      expiredCount(0)
+{
+    std::cout << "[AdvertisementScanner] Constructor called." << std::endl;
+}
+
+AdvertisementScanner::~AdvertisementScanner()
+{
+    std::cout << "[AdvertisementScanner] Destructor called." << std::endl;
+    stop();
+}
+
+// Set the discovery filter and start discovery on every powered adapter
+bool AdvertisementScanner::start(const ScanFilter &filter, AdvertisementHandler handler_)
+{
+    stop();
+    handler = handler_;
+
+    ObjectTree tree;
+    if (!dbusConnection.getConnection() || !tree.refresh(dbusConnection))
+    {
+        std::cerr << "[AdvertisementScanner] Failed to list adapters." << std::endl;
+        return false;
+    }
+
+    // Subscribe first so the advertisements that start discovery aren't missed
+    addedSignalId = dbusConnection.addSignalHandler(
+        "type='signal',sender='org.bluez',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesAdded',arg0path='/org/bluez/'",
+        "org.freedesktop.DBus.ObjectManager", "InterfacesAdded",
+        [this](DBusMessage *msg)
+        { onInterfacesAdded(msg); });
+    changedSignalId = dbusConnection.addSignalHandler(
+        "type='signal',sender='org.bluez',interface='org.freedesktop.DBus.Properties',"
+        "member='PropertiesChanged',path_namespace='/org/bluez',arg0='org.bluez.Device1'",
+        "org.freedesktop.DBus.Properties", "PropertiesChanged",
+        [this](DBusMessage *msg)
+        { onPropertiesChanged(msg); });
+    removedSignalId = dbusConnection.addSignalHandler(
+        "type='signal',sender='org.bluez',interface='org.freedesktop.DBus.ObjectManager',"
+        "member='InterfacesRemoved',arg0path='/org/bluez/'",
+        "org.freedesktop.DBus.ObjectManager", "InterfacesRemoved",
+        [this](DBusMessage *msg)
+        { onInterfacesRemoved(msg); });
+    if (addedSignalId < 0 || changedSignalId < 0 || removedSignalId < 0)
+    {
+        std::cerr << "[AdvertisementScanner] Failed to subscribe to device signals." << std::endl;
+        removeSignalHandlers();
+        return false;
+    }
+
+    for (const ManagedAdapter &adapter : tree.getAdapters())
+    {
+        if (!adapter.powered)
+        {
+            continue;
+        }
+
+        DbusMarshal::Void result;
+        if (!setDiscoveryFilter(adapter.path, &filter) ||
+            !DbusMarshal::call(dbusConnection, -1, adapter.path, "org.bluez.Adapter1", "StartDiscovery", result))
+        {
+            std::cerr << "[AdvertisementScanner] Failed to start discovery on " << adapter.path << "." << std::endl;
+            continue;
+        }
+        scanningAdapters.push_back(adapter.path);
+    }
+
+    if (scanningAdapters.empty())
+    {
+        std::cerr << "[AdvertisementScanner] No adapter is scanning." << std::endl;
+        removeSignalHandlers();
+        return false;
+    }
+
+    std::cout << "[AdvertisementScanner] Scanning on " << scanningAdapters.size() << " adapter(s)." << std::endl;
+    return true;
+}
+
+// Stop discovery and clear the filter
+void AdvertisementScanner::stop()
+{
+    removeSignalHandlers();
+
+    for (const std::string &adapterPath : scanningAdapters)
+    {
+        DbusMarshal::Void result;
+        DbusMarshal::call(dbusConnection, -1, adapterPath, "org.bluez.Adapter1", "StopDiscovery", result);
+        setDiscoveryFilter(adapterPath, nullptr);
+    }
+    if (!scanningAdapters.empty())
+    {
+        std::cout << "[AdvertisementScanner] Stopped scanning on " << scanningAdapters.size() << " adapter(s)." << std::endl;
+    }
+    scanningAdapters.clear();
+
+    // rssiDue points into devices, drop both
+    std::lock_guard<std::mutex> lock(stateMutex);
+    rssiDue = decltype(rssiDue)();
+    devices.clear();
+    telemetryDeviceCount = 0;
+}
+
+bool AdvertisementScanner::isScanning() const
+{
+    return !scanningAdapters.empty();
+}
+
+// Dispatch advertisements and due RSSI updates
+bool AdvertisementScanner::processEvents(int timeoutMs)
+{
+    // Don't sleep past the next coalesced RSSI update
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (!rssiDue.empty())
+        {
+            long long untilDue = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     rssiDue.top().first - std::chrono::steady_clock::now())
+                                     .count();
+            if (untilDue < timeoutMs)
+            {
+                timeoutMs = untilDue > 0 ? static_cast<int>(untilDue) : 0;
+            }
+        }
+    }
+
+    bool connected = dbusConnection.processEvents(timeoutMs);
+    flushRssiUpdates();
+    expireIdleDevices();
+    return connected;
+}
+
+void AdvertisementScanner::setRssiUpdateInterval(int intervalMs)
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    rssiIntervalMs = intervalMs;
+}
+
+void AdvertisementScanner::setDeviceExpiry(int idleMs)
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    deviceExpiryMs = idleMs;
+}
+
+// Send the filter to one adapter
+bool AdvertisementScanner::setDiscoveryFilter(const std::string &adapterPath, const ScanFilter *filter)
+{
+    DbusMarshal::VariantDict options;
+    if (filter)
+    {
+        options["Transport"].signature = "s";
+        options["Transport"].string = "le";
+        options["RSSI"].signature = "n";
+        options["RSSI"].integer = filter->rssiThreshold;
+        options["DuplicateData"].signature = "b";
+        options["DuplicateData"].boolean = filter->duplicateData;
+        if (!filter->serviceUUIDs.empty())
+        {
+            options["UUIDs"].signature = "as";
+            options["UUIDs"].strings.assign(filter->serviceUUIDs.begin(), filter->serviceUUIDs.end());
+        }
+    }
+
+    DbusMarshal::Void result;
+    return DbusMarshal::call(dbusConnection, -1, adapterPath, "org.bluez.Adapter1",
+                             "SetDiscoveryFilter", result, options);
+}
+
+// A device appeared with its first advertisement
+void AdvertisementScanner::onInterfacesAdded(DBusMessage *msg)
+{
+    if (!dbus_message_has_signature(msg, "oa{sa{sv}}"))
+    {
+        return;
+    }
+
+    DBusMessageIter iter;
+    dbus_message_iter_init(msg, &iter);
+    const char *path;
+    dbus_message_iter_get_basic(&iter, &path);
+    dbus_message_iter_next(&iter);
+
+    DBusMessageIter ifacesIter;
+    dbus_message_iter_recurse(&iter, &ifacesIter);
+    while (dbus_message_iter_get_arg_type(&ifacesIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter ifaceIter;
+        dbus_message_iter_recurse(&ifacesIter, &ifaceIter);
+        const char *iface;
+        dbus_message_iter_get_basic(&ifaceIter, &iface);
+        if (std::strcmp(iface, "org.bluez.Device1") == 0)
+        {
+            dbus_message_iter_next(&ifaceIter);
+            ingest(path, &ifaceIter);
+            return;
+        }
+        dbus_message_iter_next(&ifacesIter);
+    }
+}
+
+// Advertising data of a known device changed
+void AdvertisementScanner::onPropertiesChanged(DBusMessage *msg)
+{
+    const char *path = dbus_message_get_path(msg);
+    if (!path || !dbus_message_has_signature(msg, "sa{sv}as"))
+    {
+        return;
+    }
+
+    DBusMessageIter iter;
+    dbus_message_iter_init(msg, &iter);
+    const char *iface;
+    dbus_message_iter_get_basic(&iter, &iface);
+    if (std::strcmp(iface, "org.bluez.Device1") != 0)
+    {
+        return;
+    }
+    dbus_message_iter_next(&iter);
+    ingest(path, &iter);
+}
+
+// BlueZ dropped a device
+void AdvertisementScanner::onInterfacesRemoved(DBusMessage *msg)
+{
+    if (!dbus_message_has_signature(msg, "oas"))
+    {
+        return;
+    }
+
+    DBusMessageIter iter;
+    dbus_message_iter_init(msg, &iter);
+    const char *path;
+    dbus_message_iter_get_basic(&iter, &path);
+    dbus_message_iter_next(&iter);
+
+    DBusMessageIter ifacesIter;
+    dbus_message_iter_recurse(&iter, &ifacesIter);
+    while (dbus_message_iter_get_arg_type(&ifacesIter) == DBUS_TYPE_STRING)
+    {
+        const char *iface;
+        dbus_message_iter_get_basic(&ifacesIter, &iface);
+        if (std::strcmp(iface, "org.bluez.Device1") == 0)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            auto it = devices.find(path);
+            if (it != devices.end())
+            {
+                forgetDevice(it);
+            }
+            return;
+        }
+        dbus_message_iter_next(&ifacesIter);
+    }
+}
+
+// Drop a device; its queued RSSI update points into the map and goes first
+void AdvertisementScanner::forgetDevice(DeviceIterator it)
+{
+    DeviceState *state = &it->second;
+    if (state->rssiPending)
+    {
+        decltype(rssiDue) kept;
+        while (!rssiDue.empty())
+        {
+            if (rssiDue.top().second != state)
+            {
+                kept.push(rssiDue.top());
+            }
+            rssiDue.pop();
+        }
+        rssiDue.swap(kept);
+    }
+
+    if (state->hasManufacturerData || state->hasServiceData)
+    {
+        telemetryDeviceCount--;
+    }
+    expiredCount++;
+    devices.erase(it);
+}
+
+// Forget the devices that sent nothing for longer than the expiry
+void AdvertisementScanner::expireIdleDevices()
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto now = std::chrono::steady_clock::now();
+    if (deviceExpiryMs <= 0 || now < nextExpirySweep)
+    {
+        return;
+    }
+    nextExpirySweep = now + std::chrono::milliseconds(std::min(deviceExpiryMs, EXPIRY_SWEEP_INTERVAL_MS));
+
+    auto idleSince = now - std::chrono::milliseconds(deviceExpiryMs);
+    for (auto it = devices.begin(); it != devices.end();)
+    {
+        auto current = it++;
+        if (current->second.lastSeen < idleSince)
+        {
+            forgetDevice(current);
+        }
+    }
+}
+
+// Drop repeated payloads, coalesce RSSI-only changes, deliver the rest
+void AdvertisementScanner::ingest(const char *devicePath, DBusMessageIter *propsIter)
+{
+    PropertyScan scan;
+    scanProperties(propsIter, scan);
+    auto now = std::chrono::steady_clock::now();
+
+    Advertisement advertisement;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        signalCount++;
+
+        auto it = devices.find(devicePath);
+        if (it == devices.end())
+        {
+            if (!scan.hasRssi && !scan.hasManufacturerData && !scan.hasServiceData)
+            {
+                return;
+            }
+            it = devices.emplace(devicePath, DeviceState()).first;
+            it->second.devicePath = devicePath;
+            it->second.macAddress = scan.address ? scan.address : addressFromPath(devicePath);
+        }
+
+        DeviceState &state = it->second;
+        state.lastSeen = now;
+        bool hadPayload = state.hasManufacturerData || state.hasServiceData;
+        if (scan.hasRssi)
+        {
+            state.rssi = scan.rssi;
+            state.hasRssi = true;
+        }
+
+        // Only a changed hash pays for decoding the payload
+        bool dataChanged = false;
+        if (scan.hasManufacturerData && (!state.hasManufacturerData || scan.manufacturerHash != state.manufacturerHash))
+        {
+            DbusMarshal::Variant value;
+            if (DbusMarshal::Codec<DbusMarshal::Variant>::read(&scan.manufacturerIter, value))
+            {
+                state.manufacturerData.swap(value.keyedBytes);
+                state.manufacturerHash = scan.manufacturerHash;
+                state.hasManufacturerData = true;
+                dataChanged = true;
+            }
+        }
+        if (scan.hasServiceData && (!state.hasServiceData || scan.serviceHash != state.serviceHash))
+        {
+            DbusMarshal::Variant value;
+            if (DbusMarshal::Codec<DbusMarshal::Variant>::read(&scan.serviceIter, value))
+            {
+                state.serviceData.swap(value.namedBytes);
+                state.serviceHash = scan.serviceHash;
+                state.hasServiceData = true;
+                dataChanged = true;
+            }
+        }
+
+        bool deliver = dataChanged;
+        if (!dataChanged && hadPayload && state.hasRssi && state.rssi != state.deliveredRssi && rssiIntervalMs >= 0)
+        {
+            auto due = state.lastDelivery + std::chrono::milliseconds(rssiIntervalMs);
+            if (now >= due)
+            {
+                deliver = true;
+            }
+            else if (!state.rssiPending)
+            {
+                rssiDue.push(RssiDue(due, &state));
+                state.rssiPending = true;
+            }
+        }
+
+        if (!deliver)
+        {
+            suppressedCount++;
+            return;
+        }
+
+        if (!hadPayload)
+        {
+            telemetryDeviceCount++;
+        }
+        state.deliveredRssi = state.rssi;
+        state.lastDelivery = now;
+        advertisementCount++;
+        advertisement = snapshot(state, dataChanged, now);
+    }
+
+    if (handler)
+    {
+        handler(advertisement);
+    }
+}
+
+// Deliver the RSSI updates whose interval has passed
+void AdvertisementScanner::flushRssiUpdates()
+{
+    std::vector<Advertisement> updates;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        auto now = std::chrono::steady_clock::now();
+        while (!rssiDue.empty() && rssiDue.top().first <= now)
+        {
+            DeviceState *state = rssiDue.top().second;
+            rssiDue.pop();
+
+            // A payload change was delivered meanwhile, restart the interval from it
+            auto due = state->lastDelivery + std::chrono::milliseconds(rssiIntervalMs);
+            if (due > now && rssiIntervalMs >= 0)
+            {
+                rssiDue.push(RssiDue(due, state));
+                continue;
+            }
+
+            state->rssiPending = false;
+            if (state->rssi == state->deliveredRssi || rssiIntervalMs < 0)
+            {
+                continue;
+            }
+            state->deliveredRssi = state->rssi;
+            state->lastDelivery = now;
+            advertisementCount++;
+            updates.push_back(snapshot(*state, false, now));
+        }
+    }
+
+    if (handler)
+    {
+        for (const Advertisement &advertisement : updates)
+        {
+            handler(advertisement);
+        }
+    }
+}
+
+// Copy the device's current telemetry into an advertisement
+Advertisement AdvertisementScanner::snapshot(const DeviceState &state, bool dataChanged,
+                                             std::chrono::steady_clock::time_point now)
+{
+    Advertisement advertisement;
+    advertisement.devicePath = state.devicePath;
+    advertisement.macAddress = state.macAddress;
+    advertisement.rssi = state.rssi;
+    advertisement.hasRssi = state.hasRssi;
+    advertisement.dataChanged = dataChanged;
+    advertisement.manufacturerData = state.manufacturerData;
+    advertisement.serviceData = state.serviceData;
+    advertisement.receivedAt = now;
+    return advertisement;
+}
+
+void AdvertisementScanner::removeSignalHandlers()
+{
+    if (addedSignalId >= 0)
+    {
+        dbusConnection.removeSignalHandler(addedSignalId);
+        addedSignalId = -1;
+    }
+    if (changedSignalId >= 0)
+    {
+        dbusConnection.removeSignalHandler(changedSignalId);
+        changedSignalId = -1;
+    }
+    if (removedSignalId >= 0)
+    {
+        dbusConnection.removeSignalHandler(removedSignalId);
+        removedSignalId = -1;
+    }
+}
+
+unsigned long AdvertisementScanner::getSignalCount() const
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return signalCount;
+}
+
+unsigned long AdvertisementScanner::getAdvertisementCount() const
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return advertisementCount;
+}
+
+unsigned long AdvertisementScanner::getSuppressedCount() const
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return suppressedCount;
+}
+
+size_t AdvertisementScanner::getDeviceCount() const
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return telemetryDeviceCount;
+}
+
+unsigned long AdvertisementScanner::getExpiredCount() const
+{
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return expiredCount;
+}
@@ -3,10 +3,13 @@
 #include "CharacteristicManager.h"
 #include "DbusConnection.h"
 #include "Utils.h"
+#include "DbusMarshal.h"
+#include <cstring>
 #include <iostream>
 
 CharacteristicManager::CharacteristicManager(DbusConnection &dbusConn, const std::string &devicePath_)
-    : dbusConnection(dbusConn), devicePath(devicePath_)
+    : dbusConnection(dbusConn), devicePath(devicePath_), addedSignalId(-1), removedSignalId(-1),
+      readCacheTtlMs(0), valueSignalId(-1)
 {
     std::cout << "[CharacteristicManager] Constructor called." << std::endl;
 }
@@ -14,139 +17,81 @@ CharacteristicManager::CharacteristicManager(DbusConnection &dbusConn, const std
 CharacteristicManager::~CharacteristicManager()
 {
     std::cout << "[CharacteristicManager] Destructor called." << std::endl;
+    stopWatchingChanges();
+    setReadCacheTtl(0);
+
+    std::lock_guard<std::mutex> lock(tableMutex);
+    clearWriteTemplates();
 }
 
 // Getter for UUID to Path map
 std::map<std::string, std::string> CharacteristicManager::getUuidToPathMap() const
 {
+    std::lock_guard<std::mutex> lock(tableMutex);
     return uuidToPathMap;
 }
 
 // List all characteristics and populate uuidToPathMap
 bool CharacteristicManager::listAllCharacteristics()
 {
-    std::cout << "[CharacteristicManager] Listing all characteristics for device: " << devicePath << std::endl;
-
-    // Introspect the device to find services
-    DBusMessage *msg_device = dbus_message_new_method_call(
-        "org.bluez",
-        devicePath.c_str(),
-        "org.freedesktop.DBus.Introspectable",
-        "Introspect");
-
-    if (!msg_device)
-    {
-        std::cerr << "[CharacteristicManager] Failed to create Introspect message for device path: " << devicePath << "." << std::endl;
-        return false;
-    }
-
-    DBusError err_device;
-    dbus_error_init(&err_device);
-
-    DBusMessage *reply_device = dbus_connection_send_with_reply_and_block(dbusConnection.getConnection(), msg_device, -1, &err_device);
-    dbus_message_unref(msg_device);
+    return listAllCharacteristics(DiscoveryFilter());
+}
 
-    if (!reply_device)
-    {
-        if (dbus_error_is_set(&err_device))
-        {
-            std::cerr << "[CharacteristicManager] Introspect call failed for device path " << devicePath << ": " << err_device.message << std::endl;
-            dbus_error_free(&err_device);
-        }
-        else
-        {
-            std::cerr << "[CharacteristicManager] Introspect call failed for device path " << devicePath << ": Unknown error." << std::endl;
-        }
-        return false;
-    }
+// List the characteristics accepted by the filter
+bool CharacteristicManager::listAllCharacteristics(const DiscoveryFilter &filter)
+{
+    std::cout << "[CharacteristicManager] Listing all characteristics for device: " << devicePath << std::endl;
 
-    // Read the introspection XML
-    DBusMessageIter args_device;
-    if (!dbus_message_iter_init(reply_device, &args_device))
     {
-        std::cerr << "[CharacteristicManager] Introspect reply has no arguments for device path " << devicePath << "." << std::endl;
-        dbus_message_unref(reply_device);
-        return false;
+        std::lock_guard<std::mutex> lock(tableMutex);
+        clearWriteTemplates();
+        uuidToPathMap.clear();
+        serviceUuids.clear();
+        activeFilter = filter;
     }
 
-    if (DBUS_TYPE_STRING != dbus_message_iter_get_arg_type(&args_device))
+    // Introspect the device to find services
+    std::string xmlString;
+    if (!DbusMarshal::call(dbusConnection, -1, devicePath, "org.freedesktop.DBus.Introspectable", "Introspect", xmlString))
     {
-        std::cerr << "[CharacteristicManager] Introspect reply is not a string for device path " << devicePath << "." << std::endl;
-        dbus_message_unref(reply_device);
+        std::cerr << "[CharacteristicManager] Introspect call failed for device path " << devicePath << "." << std::endl;
         return false;
     }
 
-    char *xmlData;
-    dbus_message_iter_get_basic(&args_device, &xmlData);
-    std::string xmlString(xmlData);
-
-    dbus_message_unref(reply_device);
-
-    // Extract service paths
-    std::vector<std::string> servicePaths = Utils::extractChildPaths(xmlString, devicePath);
+    // Extract service paths, skipping children that are not GATT services
+    std::vector<std::string> servicePaths =
+        Utils::extractChildPaths(xmlString, devicePath, "org.bluez.GattService1", "service");
 
     std::cout << "[CharacteristicManager] Found " << servicePaths.size() << " service(s) under " << devicePath << "." << std::endl;
 
     // Iterate through each service to find characteristics
     for (const auto &servicePath : servicePaths)
     {
-        // Introspect each service to find characteristics
-        DBusMessage *msg_service = dbus_message_new_method_call(
-            "org.bluez",
-            servicePath.c_str(),
-            "org.freedesktop.DBus.Introspectable",
-            "Introspect");
-
-        if (!msg_service)
+        // Skip services outside the filter before looking at their characteristics
+        if (!filter.serviceUUIDs.empty())
         {
-            std::cerr << "[CharacteristicManager] Failed to create Introspect message for service path: " << servicePath << "." << std::endl;
-            continue;
-        }
-
-        DBusError err_service;
-        dbus_error_init(&err_service);
-
-        DBusMessage *reply_service = dbus_connection_send_with_reply_and_block(dbusConnection.getConnection(), msg_service, -1, &err_service);
-        dbus_message_unref(msg_service);
-
-        if (!reply_service)
-        {
-            if (dbus_error_is_set(&err_service))
-            {
-                std::cerr << "[CharacteristicManager] Introspect call failed for service path " << servicePath << ": " << err_service.message << std::endl;
-                dbus_error_free(&err_service);
-            }
-            else
+            std::string serviceUUID;
+            if (!DbusMarshal::getProperty(dbusConnection, -1, servicePath, "org.bluez.GattService1", "UUID", serviceUUID) ||
+                !Utils::matchesUuidFilter(filter.serviceUUIDs, serviceUUID))
             {
-                std::cerr << "[CharacteristicManager] Introspect call failed for service path " << servicePath << ": Unknown error." << std::endl;
+                std::cout << "[CharacteristicManager] Skipping service " << servicePath << "." << std::endl;
+                continue;
             }
-            continue;
-        }
 
-        // Read the introspection XML
-        DBusMessageIter args_service;
-        if (!dbus_message_iter_init(reply_service, &args_service))
-        {
-            std::cerr << "[CharacteristicManager] Introspect reply has no arguments for service path " << servicePath << "." << std::endl;
-            dbus_message_unref(reply_service);
-            continue;
+            std::lock_guard<std::mutex> lock(tableMutex);
+            serviceUuids[servicePath] = Utils::toLower(serviceUUID);
         }
 
-        if (DBUS_TYPE_STRING != dbus_message_iter_get_arg_type(&args_service))
+        // Introspect each service to find characteristics
+        std::string xmlServiceString;
+        if (!DbusMarshal::call(dbusConnection, -1, servicePath, "org.freedesktop.DBus.Introspectable", "Introspect", xmlServiceString))
         {
-            std::cerr << "[CharacteristicManager] Introspect reply is not a string for service path " << servicePath << "." << std::endl;
-            dbus_message_unref(reply_service);
             continue;
         }
 
-        char *xmlServiceData;
-        dbus_message_iter_get_basic(&args_service, &xmlServiceData);
-        std::string xmlServiceString(xmlServiceData);
-
-        dbus_message_unref(reply_service);
-
-        // Extract characteristic paths
-        std::vector<std::string> charPaths = Utils::extractChildPaths(xmlServiceString, servicePath);
+        // Extract characteristic paths, skipping included services and other children
+        std::vector<std::string> charPaths =
+            Utils::extractChildPaths(xmlServiceString, servicePath, "org.bluez.GattCharacteristic1", "char");
 
         std::cout << "[CharacteristicManager] Found " << charPaths.size() << " characteristic(s) under " << servicePath << "." << std::endl;
 
@@ -154,215 +99,601 @@ bool CharacteristicManager::listAllCharacteristics()
         for (const auto &charPath : charPaths)
         {
             // Get the UUID property of the characteristic
-            DBusMessage *msg_uuid = dbus_message_new_method_call(
-                "org.bluez",
-                charPath.c_str(),
-                "org.freedesktop.DBus.Properties",
-                "Get");
-
-            if (!msg_uuid)
+            std::string charUUID;
+            if (!DbusMarshal::getProperty(dbusConnection, -1, charPath, "org.bluez.GattCharacteristic1", "UUID", charUUID))
             {
-                std::cerr << "[CharacteristicManager] Failed to create Properties.Get message for UUID at " << charPath << "." << std::endl;
                 continue;
             }
 
-            const char *iface_uuid = "org.bluez.GattCharacteristic1";
-            const char *prop_uuid = "UUID";
-
-            dbus_message_append_args(msg_uuid,
-                                     DBUS_TYPE_STRING, &iface_uuid,
-                                     DBUS_TYPE_STRING, &prop_uuid,
-                                     DBUS_TYPE_INVALID);
-
-            DBusError err_uuid;
-            dbus_error_init(&err_uuid);
-
-            DBusMessage *reply_uuid = dbus_connection_send_with_reply_and_block(dbusConnection.getConnection(), msg_uuid, -1, &err_uuid);
-            dbus_message_unref(msg_uuid);
-
-            if (!reply_uuid)
+            if (!Utils::matchesUuidFilter(filter.characteristicUUIDs, charUUID))
             {
-                if (dbus_error_is_set(&err_uuid))
-                {
-                    std::cerr << "[CharacteristicManager] Properties.Get (UUID) call failed for " << charPath << ": " << err_uuid.message << std::endl;
-                    dbus_error_free(&err_uuid);
-                }
-                else
-                {
-                    std::cerr << "[CharacteristicManager] Properties.Get (UUID) call failed for " << charPath << ": Unknown error." << std::endl;
-                }
                 continue;
             }
 
-            // Read the UUID
-            DBusMessageIter args_uuid;
-            if (dbus_message_iter_init(reply_uuid, &args_uuid))
-            {
-                if (DBUS_TYPE_VARIANT == dbus_message_iter_get_arg_type(&args_uuid))
-                {
-                    DBusMessageIter variantIter;
-                    dbus_message_iter_recurse(&args_uuid, &variantIter);
-                    if (DBUS_TYPE_STRING == dbus_message_iter_get_arg_type(&variantIter))
-                    {
-                        char *uuidCStr;
-                        dbus_message_iter_get_basic(&variantIter, &uuidCStr);
-                        std::string charUUID(uuidCStr);
-
-                        // Convert UUID to lowercase for consistent mapping
-                        std::string lowerUUID = Utils::toLower(charUUID);
-
-                        // Store the mapping
-                        uuidToPathMap[lowerUUID] = charPath;
-
-                        // Optionally, store in characteristics vector if needed elsewhere
-                        BLECharacteristic characteristic;
-                        characteristic.path = charPath;
-                        characteristic.uuid = lowerUUID;
-                        // characteristics.push_back(characteristic); // Not used here
-                    }
-                }
-            }
-
-            dbus_message_unref(reply_uuid);
+            // Store the mapping, with the UUID in lowercase for consistent lookups
+            addCharacteristic(Utils::toLower(charUUID), charPath);
         }
     }
 
     return true;
 }
 
-// Write to a characteristic
-bool CharacteristicManager::writeCharacteristic(const std::string &charPath, const std::string &value)
+// Use a known UUID to path table instead of discovering it
+void CharacteristicManager::loadUuidToPathMap(const std::map<std::string, std::string> &table)
 {
-    DBusMessage *msg = dbus_message_new_method_call(
+    std::lock_guard<std::mutex> lock(tableMutex);
+    clearWriteTemplates();
+    serviceUuids.clear();
+    uuidToPathMap.clear();
+    for (const auto &entry : table)
+    {
+        uuidToPathMap[Utils::toLower(entry.first)] = entry.second;
+        cacheWriteTemplate(entry.second);
+    }
+}
+
+// Store a characteristic and its write template
+void CharacteristicManager::addCharacteristic(const std::string &uuid, const std::string &charPath)
+{
+    std::lock_guard<std::mutex> lock(tableMutex);
+    uuidToPathMap[uuid] = charPath;
+    cacheWriteTemplate(charPath);
+}
+
+// Build a WriteValue message without payload
+DBusMessage *CharacteristicManager::newWriteMessage(const std::string &charPath) const
+{
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = writeTemplates.find(charPath);
+    if (it != writeTemplates.end())
+    {
+        // Copying the template skips the path/interface/member validation
+        return dbus_message_copy(it->second);
+    }
+
+    return dbus_message_new_method_call(
         "org.bluez",
         charPath.c_str(),
         "org.bluez.GattCharacteristic1",
         "WriteValue");
+}
+
+// Cache the WriteValue header template of a discovered characteristic, tableMutex must be held
+void CharacteristicManager::cacheWriteTemplate(const std::string &charPath)
+{
+    if (writeTemplates.find(charPath) != writeTemplates.end())
+    {
+        return;
+    }
+
+    DBusMessage *tmpl = dbus_message_new_method_call(
+        "org.bluez",
+        charPath.c_str(),
+        "org.bluez.GattCharacteristic1",
+        "WriteValue");
+
+    if (tmpl)
+    {
+        writeTemplates[charPath] = tmpl;
+    }
+}
+
+// Release all cached templates, tableMutex must be held
+void CharacteristicManager::clearWriteTemplates()
+{
+    for (auto &entry : writeTemplates)
+    {
+        dbus_message_unref(entry.second);
+    }
+    writeTemplates.clear();
+}
+
+// Build a complete WriteValue message for value
+DBusMessage *CharacteristicManager::buildWriteMessage(const std::string &charPath, const std::string &value) const
+{
+    DBusMessage *msg = newWriteMessage(charPath);
 
     if (!msg)
     {
         std::cerr << "[CharacteristicManager] Failed to create WriteValue message for path: " << charPath << "." << std::endl;
-        return false;
+        return nullptr;
     }
 
-    DBusMessageIter args;
-    dbus_message_iter_init_append(msg, &args);
+    // Payload as a byte array in one block, followed by empty write options
+    DbusMarshal::ByteSpan payload = {reinterpret_cast<const uint8_t *>(value.data()), value.size()};
+    DbusMarshal::appendArgs(msg, payload, DbusMarshal::VariantDict());
+    return msg;
+}
 
-    // Use DBUS_TYPE_ARRAY with 'y' (byte) as the type to append a string as a byte array
-    DBusMessageIter arrayIter;
-    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "y", &arrayIter);
-    for (const char &byte : value)
+// Write to a characteristic
+bool CharacteristicManager::writeCharacteristic(const std::string &charPath, const std::string &value,
+                                                TrafficClass trafficClass, WriteMode writeMode,
+                                                int timeoutMs, const CancellationToken *cancel)
+{
+    // A notified Value may no longer hold once the device handled this write
     {
-        unsigned char byteData = static_cast<unsigned char>(byte);
-        dbus_message_iter_append_basic(&arrayIter, DBUS_TYPE_BYTE, &byteData);
+        std::lock_guard<std::mutex> lock(readMutex);
+        valueCache.erase(charPath);
     }
-    dbus_message_iter_close_container(&args, &arrayIter);
 
-    // Empty dictionary (for write options)
-    DBusMessageIter dictIter;
-    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &dictIter);
-    dbus_message_iter_close_container(&args, &dictIter);
+    DBusMessage *msg = buildWriteMessage(charPath, value);
+    if (!msg)
+    {
+        return false;
+    }
 
-    DBusError err;
-    dbus_error_init(&err);
+    DBusConnection *conn = dbusConnection.getConnection(trafficClass, devicePath);
+
+    if (writeMode == WriteMode::FireAndForget)
+    {
+        // Don't wait for the method return; the device's result is not observable
+        bool sent = dbusConnection.sendNoReply(msg, conn);
+        dbus_message_unref(msg);
+        return sent;
+    }
 
-    DBusMessage *reply = dbus_connection_send_with_reply_and_block(dbusConnection.getConnection(), msg, -1, &err);
+    // Waiting through DbusConnection lets a link loss fail the write right away
+    DBusMessage *reply = dbusConnection.callAndWait(msg, conn, timeoutMs, "WriteValue on " + charPath, nullptr, cancel);
     dbus_message_unref(msg);
 
     if (!reply)
     {
-        if (dbus_error_is_set(&err))
-        {
-            std::cerr << "[CharacteristicManager] WriteValue call failed for " << charPath << ": " << err.message << std::endl;
-            dbus_error_free(&err);
-        }
-        else
-        {
-            std::cerr << "[CharacteristicManager] WriteValue call failed for " << charPath << ": Unknown error." << std::endl;
-        }
         return false;
     }
 
+    DbusMarshal::Void result;
+    bool ok = DbusMarshal::readReply(reply, result);
     dbus_message_unref(reply);
+    return ok;
+}
+
+// Start a WriteValue without waiting for its reply
+DBusPendingCall *CharacteristicManager::writeCharacteristicAsync(const std::string &charPath, const std::string &value,
+                                                                 int timeoutMs, TrafficClass trafficClass)
+{
+    DBusMessage *msg = buildWriteMessage(charPath, value);
+    if (!msg)
+    {
+        return nullptr;
+    }
+
+    DBusPendingCall *pending = dbusConnection.sendWithReply(msg, dbusConnection.getConnection(trafficClass, devicePath), timeoutMs);
+    dbus_message_unref(msg);
+    return pending;
+}
+
+// Start a ReadValue without waiting for its reply
+DBusPendingCall *CharacteristicManager::readCharacteristicAsync(const std::string &charPath, int timeoutMs,
+                                                                TrafficClass trafficClass)
+{
+    DBusMessage *msg = dbus_message_new_method_call(DbusMarshal::BUS_NAME, charPath.c_str(),
+                                                    "org.bluez.GattCharacteristic1", "ReadValue");
+    if (!msg)
+    {
+        std::cerr << "[CharacteristicManager] Failed to create ReadValue message for path: " << charPath << "." << std::endl;
+        return nullptr;
+    }
+
+    DbusMarshal::appendArgs(msg, DbusMarshal::VariantDict());
+    DBusPendingCall *pending = dbusConnection.sendWithReply(msg, dbusConnection.getConnection(trafficClass, devicePath), timeoutMs);
+    dbus_message_unref(msg);
+    if (pending)
+    {
+        std::lock_guard<std::mutex> lock(readMutex);
+        readStats.overTheAir++;
+    }
+    return pending;
+}
+
+// Enable notifications on a characteristic
+bool CharacteristicManager::startNotify(const std::string &charPath)
+{
+    DbusMarshal::Void result;
+    if (!DbusMarshal::call(dbusConnection, -1, charPath, "org.bluez.GattCharacteristic1", "StartNotify", result))
+    {
+        std::cerr << "[CharacteristicManager] StartNotify call failed for " << charPath << "." << std::endl;
+        return false;
+    }
     return true;
 }
 
-// Read from a characteristic
-bool CharacteristicManager::readCharacteristic(const std::string &charPath, std::string &value)
+// Start a StartNotify call without waiting for its reply
+DBusPendingCall *CharacteristicManager::startNotifyAsync(const std::string &charPath, int timeoutMs)
 {
     DBusMessage *msg = dbus_message_new_method_call(
         "org.bluez",
         charPath.c_str(),
         "org.bluez.GattCharacteristic1",
-        "ReadValue");
+        "StartNotify");
 
     if (!msg)
     {
-        std::cerr << "[CharacteristicManager] Failed to create ReadValue message for path: " << charPath << "." << std::endl;
+        std::cerr << "[CharacteristicManager] Failed to create StartNotify message for path: " << charPath << "." << std::endl;
+        return nullptr;
+    }
+
+    DBusPendingCall *pending = dbusConnection.sendWithReply(msg, dbusConnection.getConnection(), timeoutMs);
+    dbus_message_unref(msg);
+    return pending;
+}
+
+// Disable notifications on a characteristic
+bool CharacteristicManager::stopNotify(const std::string &charPath)
+{
+    DbusMarshal::Void result;
+    if (!DbusMarshal::call(dbusConnection, -1, charPath, "org.bluez.GattCharacteristic1", "StopNotify", result))
+    {
+        std::cerr << "[CharacteristicManager] StopNotify call failed for " << charPath << "." << std::endl;
         return false;
     }
+    return true;
+}
+
+// Read from a characteristic, joining a read of the same characteristic already in flight
+bool CharacteristicManager::readCharacteristic(const std::string &charPath, std::string &value,
+                                               TrafficClass trafficClass, int timeoutMs,
+                                               const CancellationToken *cancel, const ReadCallGuard *guard)
+{
+    std::shared_ptr<ReadFlight> flight;
+    {
+        std::unique_lock<std::mutex> lock(readMutex);
+        if (readCacheTtlMs > 0)
+        {
+            auto cached = valueCache.find(charPath);
+            if (cached != valueCache.end() &&
+                std::chrono::steady_clock::now() - cached->second.receivedAt < std::chrono::milliseconds(readCacheTtlMs))
+            {
+                readStats.cacheHits++;
+                value = cached->second.value;
+                return true;
+            }
+        }
+
+        auto inFlight = readFlights.find(charPath);
+        if (inFlight != readFlights.end())
+        {
+            readStats.coalesced++;
+            // Own a reference, the leader erases the map entry while we wait
+            std::shared_ptr<ReadFlight> joined = inFlight->second;
+            return joinRead(lock, joined, value, timeoutMs, cancel);
+        }
+
+        if (guard && guard->admit && !guard->admit())
+        {
+            return false;
+        }
+        flight = std::make_shared<ReadFlight>();
+        readFlights[charPath] = flight;
+        readStats.overTheAir++;
+    }
+
+    bool ok = readValue(charPath, value, trafficClass, timeoutMs, cancel);
+    if (guard && guard->outcome && (!cancel || !cancel->isCancelled()))
+    {
+        guard->outcome(ok);
+    }
 
-    // Empty dictionary for options
-    DBusMessageIter args;
-    dbus_message_iter_init_append(msg, &args);
-    DBusMessageIter dictIter;
-    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &dictIter);
-    dbus_message_iter_close_container(&args, &dictIter);
+    {
+        std::lock_guard<std::mutex> lock(readMutex);
+        flight->done = true;
+        flight->ok = ok;
+        flight->value = value;
+        readFlights.erase(charPath);
+    }
+    readDone.notify_all();
+    return ok;
+}
 
-    DBusError err;
-    dbus_error_init(&err);
+// Wait for the read in flight, bounded by the caller's own timeout and token
+bool CharacteristicManager::joinRead(std::unique_lock<std::mutex> &lock, const std::shared_ptr<ReadFlight> &flight,
+                                     std::string &value, int timeoutMs, const CancellationToken *cancel)
+{
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(timeoutMs < 0 ? dbusConnection.getDefaultCallTimeout() : timeoutMs);
+    while (!flight->done)
+    {
+        if ((cancel && cancel->isCancelled()) || std::chrono::steady_clock::now() >= deadline)
+        {
+            std::cerr << "[CharacteristicManager] Gave up waiting for a shared ReadValue." << std::endl;
+            return false;
+        }
 
-    DBusMessage *reply = dbus_connection_send_with_reply_and_block(dbusConnection.getConnection(), msg, -1, &err);
-    dbus_message_unref(msg);
+        // Wake up now and then to notice a cancel from another thread
+        readDone.wait_for(lock, std::chrono::milliseconds(50));
+    }
 
-    if (!reply)
+    value = flight->value;
+    return flight->ok;
+}
+
+// Serve reads from recently notified Values for ttlMs
+bool CharacteristicManager::setReadCacheTtl(int ttlMs)
+{
+    if (ttlMs <= 0)
     {
-        if (dbus_error_is_set(&err))
+        if (valueSignalId >= 0)
         {
-            std::cerr << "[CharacteristicManager] ReadValue call failed for " << charPath << ": " << err.message << std::endl;
-            dbus_error_free(&err);
+            dbusConnection.removeSignalHandler(valueSignalId);
+            valueSignalId = -1;
         }
-        else
+        std::lock_guard<std::mutex> lock(readMutex);
+        readCacheTtlMs = 0;
+        valueCache.clear();
+        return true;
+    }
+
+    if (valueSignalId < 0)
+    {
+        valueSignalId = dbusConnection.addSignalHandler(
+            "type='signal',sender='org.bluez',interface='org.freedesktop.DBus.Properties',"
+            "member='PropertiesChanged',path_namespace='" +
+                devicePath + "',arg0='org.bluez.GattCharacteristic1'",
+            "org.freedesktop.DBus.Properties", "PropertiesChanged",
+            [this](DBusMessage *msg)
+            { onValueChanged(msg); });
+        if (valueSignalId < 0)
         {
-            std::cerr << "[CharacteristicManager] ReadValue call failed for " << charPath << ": Unknown error." << std::endl;
+            std::cerr << "[CharacteristicManager] Failed to watch values under " << devicePath << "." << std::endl;
+            return false;
         }
+    }
+
+    std::lock_guard<std::mutex> lock(readMutex);
+    readCacheTtlMs = ttlMs;
+    return true;
+}
+
+// Cache a Value notified through PropertiesChanged
+void CharacteristicManager::onValueChanged(DBusMessage *msg)
+{
+    const char *path = dbus_message_get_path(msg);
+    if (!path || std::strncmp(path, devicePath.c_str(), devicePath.size()) != 0 || path[devicePath.size()] != '/')
+    {
+        return;
+    }
+
+    std::string iface;
+    DbusMarshal::VariantDict changed;
+    std::vector<std::string> invalidated;
+    if (!DbusMarshal::readArgs(msg, iface, changed, invalidated) || iface != "org.bluez.GattCharacteristic1")
+    {
+        return;
+    }
+
+    auto changedValue = changed.find("Value");
+    if (changedValue == changed.end())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(readMutex);
+    CachedValue &cached = valueCache[path];
+    cached.value.assign(changedValue->second.bytes.begin(), changedValue->second.bytes.end());
+    cached.receivedAt = std::chrono::steady_clock::now();
+}
+
+ReadStats CharacteristicManager::getReadStats() const
+{
+    std::lock_guard<std::mutex> lock(readMutex);
+    return readStats;
+}
+
+// Send a ReadValue and wait for its reply
+bool CharacteristicManager::readValue(const std::string &charPath, std::string &value, TrafficClass trafficClass,
+                                      int timeoutMs, const CancellationToken *cancel)
+{
+    DBusMessage *msg = dbus_message_new_method_call(DbusMarshal::BUS_NAME, charPath.c_str(),
+                                                    "org.bluez.GattCharacteristic1", "ReadValue");
+    if (!msg)
+    {
+        std::cerr << "[CharacteristicManager] Failed to create ReadValue message for path: " << charPath << "." << std::endl;
         return false;
     }
 
-    // Read the byte array from the reply
-    DBusMessageIter iter;
-    if (!dbus_message_iter_init(reply, &iter))
+    // ReadValue takes an empty options dictionary and returns the value as bytes
+    DbusMarshal::appendArgs(msg, DbusMarshal::VariantDict());
+    DBusConnection *conn = dbusConnection.getConnection(trafficClass, devicePath);
+    DBusMessage *reply = dbusConnection.callAndWait(msg, conn, timeoutMs, "ReadValue on " + charPath, nullptr, cancel);
+    dbus_message_unref(msg);
+    if (!reply)
     {
-        std::cerr << "[CharacteristicManager] ReadValue reply has no arguments for path " << charPath << "." << std::endl;
-        dbus_message_unref(reply);
         return false;
     }
 
-    if (DBUS_TYPE_ARRAY != dbus_message_iter_get_arg_type(&iter))
+    std::vector<uint8_t> bytes;
+    bool ok = DbusMarshal::readReply(reply, bytes);
+    dbus_message_unref(reply);
+    if (!ok)
     {
-        std::cerr << "[CharacteristicManager] ReadValue reply is not an array for path " << charPath << "." << std::endl;
-        dbus_message_unref(reply);
         return false;
     }
 
-    DBusMessageIter arrayIter;
-    dbus_message_iter_recurse(&iter, &arrayIter);
+    // Set the received value
+    value.assign(bytes.begin(), bytes.end());
+    return true;
+}
 
-    std::string receivedValue;
-    while (dbus_message_iter_get_arg_type(&arrayIter) != DBUS_TYPE_INVALID)
+// Subscribe to object changes below the device
+bool CharacteristicManager::watchChanges(CharacteristicChangeHandler handler)
+{
+    stopWatchingChanges();
+    changeHandler = handler;
+
+    // arg0path limits the bus traffic to objects below the device
+    std::string ruleBase = "type='signal',sender='org.bluez',interface='org.freedesktop.DBus.ObjectManager',";
+    std::string pathMatch = ",arg0path='" + devicePath + "/'";
+
+    addedSignalId = dbusConnection.addSignalHandler(
+        ruleBase + "member='InterfacesAdded'" + pathMatch,
+        "org.freedesktop.DBus.ObjectManager", "InterfacesAdded",
+        [this](DBusMessage *msg)
+        { onInterfacesAdded(msg); });
+    removedSignalId = dbusConnection.addSignalHandler(
+        ruleBase + "member='InterfacesRemoved'" + pathMatch,
+        "org.freedesktop.DBus.ObjectManager", "InterfacesRemoved",
+        [this](DBusMessage *msg)
+        { onInterfacesRemoved(msg); });
+
+    if (addedSignalId < 0 || removedSignalId < 0)
     {
-        if (dbus_message_iter_get_arg_type(&arrayIter) == DBUS_TYPE_BYTE)
+        std::cerr << "[CharacteristicManager] Failed to watch service changes for " << devicePath << "." << std::endl;
+        stopWatchingChanges();
+        return false;
+    }
+
+    std::cout << "[CharacteristicManager] Watching service changes for " << devicePath << "." << std::endl;
+    return true;
+}
+
+// Stop following service changes
+void CharacteristicManager::stopWatchingChanges()
+{
+    if (addedSignalId >= 0)
+    {
+        dbusConnection.removeSignalHandler(addedSignalId);
+        addedSignalId = -1;
+    }
+    if (removedSignalId >= 0)
+    {
+        dbusConnection.removeSignalHandler(removedSignalId);
+        removedSignalId = -1;
+    }
+}
+
+// A service or characteristic appeared: add it when the discovery filter accepts it
+void CharacteristicManager::onInterfacesAdded(DBusMessage *msg)
+{
+    DbusMarshal::ObjectPath objectPath;
+    std::map<std::string, DbusMarshal::VariantDict> interfaces;
+    if (!DbusMarshal::readArgs(msg, objectPath, interfaces))
+    {
+        return;
+    }
+
+    const std::string &path = objectPath.value;
+    if (path.compare(0, devicePath.size() + 1, devicePath + "/") != 0)
+    {
+        return;
+    }
+
+    // Services are announced before their characteristics, remember their UUID
+    auto service = interfaces.find("org.bluez.GattService1");
+    if (service != interfaces.end())
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        serviceUuids[path] = Utils::toLower(service->second["UUID"].string);
+    }
+
+    auto characteristic = interfaces.find("org.bluez.GattCharacteristic1");
+    if (characteristic == interfaces.end())
+    {
+        return;
+    }
+
+    DbusMarshal::VariantDict &properties = characteristic->second;
+    std::string charUUID = Utils::toLower(properties["UUID"].string);
+    if (charUUID.empty())
+    {
+        return;
+    }
+
+    if (!activeFilter.serviceUUIDs.empty())
+    {
+        const std::string &servicePath = properties["Service"].string;
+        std::string serviceUUID;
         {
-            unsigned char byte;
-            dbus_message_iter_get_basic(&arrayIter, &byte);
-            receivedValue.push_back(static_cast<char>(byte));
+            std::lock_guard<std::mutex> lock(tableMutex);
+            auto it = serviceUuids.find(servicePath);
+            if (it != serviceUuids.end())
+            {
+                serviceUUID = it->second;
+            }
+        }
+        if (serviceUUID.empty())
+        {
+            DbusMarshal::getProperty(dbusConnection, -1, servicePath, "org.bluez.GattService1", "UUID", serviceUUID);
+        }
+        if (!Utils::matchesUuidFilter(activeFilter.serviceUUIDs, serviceUUID))
+        {
+            return;
         }
-        dbus_message_iter_next(&arrayIter);
     }
 
-    // Set the received value
-    value = receivedValue;
+    if (!Utils::matchesUuidFilter(activeFilter.characteristicUUIDs, charUUID))
+    {
+        return;
+    }
 
-    dbus_message_unref(reply);
-    return true;
+    addCharacteristic(charUUID, path);
+    std::cout << "[CharacteristicManager] Characteristic " << charUUID << " added at " << path << "." << std::endl;
+
+    if (changeHandler)
+    {
+        changeHandler(charUUID, path);
+    }
+}
+
+// A service or characteristic disappeared: drop it and everything below it
+void CharacteristicManager::onInterfacesRemoved(DBusMessage *msg)
+{
+    DbusMarshal::ObjectPath objectPath;
+    std::vector<std::string> interfaces;
+    if (!DbusMarshal::readArgs(msg, objectPath, interfaces))
+    {
+        return;
+    }
+
+    const std::string &path = objectPath.value;
+    if (path.compare(0, devicePath.size() + 1, devicePath + "/") != 0)
+    {
+        return;
+    }
+
+    bool gattObject = false;
+    for (const std::string &iface : interfaces)
+    {
+        if (iface == "org.bluez.GattService1" || iface == "org.bluez.GattCharacteristic1")
+        {
+            gattObject = true;
+        }
+    }
+    if (!gattObject)
+    {
+        return;
+    }
+
+    std::vector<std::string> removedUUIDs;
+    {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        std::string childPrefix = path + "/";
+        for (auto it = uuidToPathMap.begin(); it != uuidToPathMap.end();)
+        {
+            const std::string &charPath = it->second;
+            if (charPath == path || charPath.compare(0, childPrefix.size(), childPrefix) == 0)
+            {
+                auto tmpl = writeTemplates.find(charPath);
+                if (tmpl != writeTemplates.end())
+                {
+                    dbus_message_unref(tmpl->second);
+                    writeTemplates.erase(tmpl);
+                }
+                removedUUIDs.push_back(it->first);
+                it = uuidToPathMap.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        serviceUuids.erase(path);
+    }
+
+    for (const std::string &uuid : removedUUIDs)
+    {
+        std::cout << "[CharacteristicManager] Characteristic " << uuid << " removed with " << path << "." << std::endl;
+        if (changeHandler)
+        {
+            changeHandler(uuid, "");
+        }
+    }
 }
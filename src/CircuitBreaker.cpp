@@ -0,0 +1,132 @@
+// src/CircuitBreaker.cpp
+
+#include "CircuitBreaker.h"
+#include "Utils.h"
+#include <iostream>
+
+CircuitBreaker::CircuitBreaker(const BreakerPolicy &policy_)
+    : policy(policy_)
+{
+    if (policy.failureThreshold < 1)
+    {
+        policy.failureThreshold = 1;
+    }
+    std::cout << "[CircuitBreaker] Constructor called." << std::endl;
+}
+
+CircuitBreaker::~CircuitBreaker()
+{
+    std::cout << "[CircuitBreaker] Destructor called." << std::endl;
+}
+
+// Breaker of a device, created closed
+CircuitBreaker::Breaker &CircuitBreaker::breakerFor(const std::string &macAddress)
+{
+    std::string key = Utils::toLower(macAddress);
+    auto it = breakers.find(key);
+    if (it == breakers.end())
+    {
+        it = breakers.insert(std::make_pair(key, Breaker())).first;
+        it->second.macAddress = macAddress;
+    }
+    return it->second;
+}
+
+// Let the call through unless the breaker is open; once per interval it goes out as a probe
+bool CircuitBreaker::allowCall(const std::string &macAddress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Breaker &breaker = breakerFor(macAddress);
+    if (breaker.state == BreakerState::Closed)
+    {
+        return true;
+    }
+
+    // A half-open probe whose outcome never came in is replaced after an interval
+    auto now = std::chrono::steady_clock::now();
+    if (now >= breaker.nextProbeAt)
+    {
+        breaker.state = BreakerState::HalfOpen;
+        breaker.nextProbeAt = now + std::chrono::milliseconds(policy.probeIntervalMs);
+        breaker.probes++;
+        std::cout << "[CircuitBreaker] Probing " << breaker.macAddress << "." << std::endl;
+        return true;
+    }
+
+    breaker.rejected++;
+    return false;
+}
+
+void CircuitBreaker::recordSuccess(const std::string &macAddress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Breaker &breaker = breakerFor(macAddress);
+    if (breaker.state != BreakerState::Closed)
+    {
+        std::cout << "[CircuitBreaker] " << breaker.macAddress << " answered, breaker closed." << std::endl;
+    }
+    breaker.state = BreakerState::Closed;
+    breaker.consecutiveFailures = 0;
+}
+
+void CircuitBreaker::recordFailure(const std::string &macAddress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Breaker &breaker = breakerFor(macAddress);
+    breaker.consecutiveFailures++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (breaker.state == BreakerState::HalfOpen)
+    {
+        // Failed probe, wait another interval
+        breaker.state = BreakerState::Open;
+        breaker.nextProbeAt = now + std::chrono::milliseconds(policy.probeIntervalMs);
+    }
+    else if (breaker.state == BreakerState::Closed && breaker.consecutiveFailures >= policy.failureThreshold)
+    {
+        breaker.state = BreakerState::Open;
+        breaker.openedAt = now;
+        breaker.nextProbeAt = now + std::chrono::milliseconds(policy.probeIntervalMs);
+        breaker.trips++;
+        std::cerr << "[CircuitBreaker] " << breaker.macAddress << " failed " << breaker.consecutiveFailures
+                  << " time(s) in a row, breaker opened." << std::endl;
+    }
+}
+
+BreakerState CircuitBreaker::getState(const std::string &macAddress) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = breakers.find(Utils::toLower(macAddress));
+    return it == breakers.end() ? BreakerState::Closed : it->second.state;
+}
+
+void CircuitBreaker::reset(const std::string &macAddress)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Breaker &breaker = breakerFor(macAddress);
+    breaker.state = BreakerState::Closed;
+    breaker.consecutiveFailures = 0;
+}
+
+std::vector<DeviceBreakerStats> CircuitBreaker::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    std::vector<DeviceBreakerStats> stats;
+    for (const auto &entry : breakers)
+    {
+        const Breaker &breaker = entry.second;
+        DeviceBreakerStats device;
+        device.macAddress = breaker.macAddress;
+        device.state = breaker.state;
+        device.consecutiveFailures = breaker.consecutiveFailures;
+        device.trips = breaker.trips;
+        device.rejected = breaker.rejected;
+        device.probes = breaker.probes;
+        device.openForMs = breaker.state == BreakerState::Closed
+                               ? 0.0
+                               : std::chrono::duration<double, std::milli>(now - breaker.openedAt).count();
+        stats.push_back(device);
+    }
+    return stats;
+}
@@ -0,0 +1,287 @@
+// src/ConnectionScheduler.cpp
+
+#include "ConnectionScheduler.h"
+#include "Utils.h"
+#include <iostream>
+
+ConnectionScheduler::ConnectionScheduler(BLEManager &bleMgr, int maxConnections_)
+    : bleManager(bleMgr), maxConnections(maxConnections_ > 0 ? maxConnections_ : 1),
+      policy(SchedulePolicy::RoundRobin), roundRobinCursor(0)
+{
+    std::cout << "[ConnectionScheduler] Constructor called." << std::endl;
+}
+
+ConnectionScheduler::~ConnectionScheduler()
+{
+    std::cout << "[ConnectionScheduler] Destructor called." << std::endl;
+}
+
+// Add a device to the pool
+void ConnectionScheduler::addDevice(const std::string &macAddress, int priority)
+{
+    PooledDevice *existing = find(macAddress);
+    if (existing)
+    {
+        existing->priority = priority > 0 ? priority : 1;
+        return;
+    }
+
+    PooledDevice device;
+    device.macAddress = macAddress;
+    device.priority = priority > 0 ? priority : 1;
+    device.connected = false;
+    device.turns = 0;
+    device.failures = 0;
+    device.served = false;
+    device.attempted = false;
+    device.lastTurnMs = 0.0;
+    pool.push_back(device);
+}
+
+// Remove a device from the pool, releasing its connection
+void ConnectionScheduler::removeDevice(const std::string &macAddress)
+{
+    for (auto it = pool.begin(); it != pool.end(); ++it)
+    {
+        if (Utils::toLower(it->macAddress) != Utils::toLower(macAddress))
+        {
+            continue;
+        }
+        if (it->connected)
+        {
+            bleManager.releaseConnection(it->macAddress);
+        }
+        size_t index = it - pool.begin();
+        pool.erase(it);
+        if (roundRobinCursor > index)
+        {
+            --roundRobinCursor;
+        }
+        return;
+    }
+}
+
+void ConnectionScheduler::setPolicy(SchedulePolicy policy_)
+{
+    policy = policy_;
+}
+
+void ConnectionScheduler::setDiscoveryFilter(const DiscoveryFilter &filter)
+{
+    discoveryFilter = filter;
+}
+
+void ConnectionScheduler::setTurnHandler(TurnHandler handler)
+{
+    turnHandler = handler;
+}
+
+// Queue a write for the device's next turn
+bool ConnectionScheduler::queueWrite(const std::string &macAddress, const std::string &uuid, const std::string &payload)
+{
+    PooledDevice *device = find(macAddress);
+    if (!device)
+    {
+        std::cerr << "[ConnectionScheduler] " << macAddress << " is not in the pool." << std::endl;
+        return false;
+    }
+
+    QueuedWrite write = {uuid, payload};
+    device->writes.push_back(write);
+    return true;
+}
+
+// Serve the next device
+bool ConnectionScheduler::runTurn()
+{
+    PooledDevice *device = nextDevice();
+    if (!device)
+    {
+        return false;
+    }
+    return serve(*device);
+}
+
+// Serve turns until durationMs has passed
+void ConnectionScheduler::runFor(int durationMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(durationMs);
+    while (!pool.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        runTurn();
+    }
+}
+
+// Release every connection held by the scheduler
+void ConnectionScheduler::releaseAll()
+{
+    for (PooledDevice &device : pool)
+    {
+        if (device.connected)
+        {
+            bleManager.releaseConnection(device.macAddress);
+            device.connected = false;
+        }
+    }
+}
+
+// Pick the device whose turn is next
+ConnectionScheduler::PooledDevice *ConnectionScheduler::nextDevice()
+{
+    if (pool.empty())
+    {
+        return nullptr;
+    }
+
+    if (policy == SchedulePolicy::RoundRobin)
+    {
+        PooledDevice *device = &pool[roundRobinCursor % pool.size()];
+        roundRobinCursor = (roundRobinCursor + 1) % pool.size();
+        return device;
+    }
+
+    // Time since the last attempt weighted by priority, so failing devices don't starve the rest
+    auto now = std::chrono::steady_clock::now();
+    PooledDevice *best = nullptr;
+    double bestScore = 0.0;
+    for (PooledDevice &device : pool)
+    {
+        if (!device.attempted)
+        {
+            return &device;
+        }
+        double waitedMs = std::chrono::duration<double, std::milli>(now - device.lastAttempt).count();
+        double score = waitedMs * device.priority;
+        if (!best || score > bestScore)
+        {
+            best = &device;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+// Release the connection served least recently when every slot is in use
+void ConnectionScheduler::makeRoom(const PooledDevice &device)
+{
+    if (device.connected)
+    {
+        return;
+    }
+
+    int connectedCount = 0;
+    PooledDevice *oldest = nullptr;
+    for (PooledDevice &pooled : pool)
+    {
+        if (!pooled.connected)
+        {
+            continue;
+        }
+        ++connectedCount;
+        // A device connected by failed turns only was never served and goes first
+        if (!oldest || pooled.lastServed < oldest->lastServed)
+        {
+            oldest = &pooled;
+        }
+    }
+
+    if (connectedCount >= maxConnections && oldest)
+    {
+        bleManager.releaseConnection(oldest->macAddress);
+        oldest->connected = false;
+    }
+}
+
+// Connect, load characteristics, drain writes, run the handler
+bool ConnectionScheduler::serve(PooledDevice &device)
+{
+    auto start = std::chrono::steady_clock::now();
+    device.attempted = true;
+    device.lastAttempt = start;
+
+    makeRoom(device);
+
+    // A failed connect holds no slot, whatever an earlier turn left behind
+    bool ok = bleManager.connectToDevice(device.macAddress);
+    device.connected = ok;
+    if (ok)
+    {
+        ok = bleManager.listAllCharacteristics(discoveryFilter);
+    }
+
+    // Writes stay queued from the first failure on, in their original order
+    size_t sent = 0;
+    while (ok && !device.writes.empty())
+    {
+        const QueuedWrite &write = device.writes.front();
+        if (!bleManager.writeToPipe(write.uuid, write.payload))
+        {
+            ok = false;
+            break;
+        }
+        device.writes.pop_front();
+        ++sent;
+    }
+
+    if (ok && turnHandler)
+    {
+        ok = turnHandler(bleManager, device.macAddress);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    device.lastTurnMs = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ok)
+    {
+        device.turns++;
+        device.served = true;
+        device.lastServed = end;
+    }
+    else
+    {
+        device.failures++;
+        // The link may have dropped during the turn, makeRoom must not count a phantom slot
+        if (device.connected)
+        {
+            device.connected = bleManager.isDeviceConnected(device.macAddress);
+        }
+    }
+
+    std::cout << "[ConnectionScheduler] Turn of " << device.macAddress << (ok ? " done" : " failed") << " in "
+              << device.lastTurnMs << " ms, " << sent << " write(s) sent, " << device.writes.size() << " queued." << std::endl;
+    return ok;
+}
+
+ConnectionScheduler::PooledDevice *ConnectionScheduler::find(const std::string &macAddress)
+{
+    std::string wanted = Utils::toLower(macAddress);
+    for (PooledDevice &device : pool)
+    {
+        if (Utils::toLower(device.macAddress) == wanted)
+        {
+            return &device;
+        }
+    }
+    return nullptr;
+}
+
+// Per-device view of the schedule
+std::vector<ScheduledDeviceStatus> ConnectionScheduler::getStatus() const
+{
+    auto now = std::chrono::steady_clock::now();
+    std::vector<ScheduledDeviceStatus> status;
+    for (const PooledDevice &device : pool)
+    {
+        ScheduledDeviceStatus entry;
+        entry.macAddress = device.macAddress;
+        entry.priority = device.priority;
+        entry.connected = device.connected;
+        entry.queuedWrites = device.writes.size();
+        entry.turns = device.turns;
+        entry.failures = device.failures;
+        entry.stalenessMs = device.served ? std::chrono::duration<double, std::milli>(now - device.lastServed).count() : -1.0;
+        entry.lastTurnMs = device.lastTurnMs;
+        entry.breaker = bleManager.getBreakerState(device.macAddress);
+        status.push_back(entry);
+    }
+    return status;
+}
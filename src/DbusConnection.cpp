@@ -1,8 +1,49 @@
 #include "DbusConnection.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 
+// Timeout of calls passing -1, well below libdbus's 25 s so one stuck device can't stall the caller
+static const int DEFAULT_CALL_TIMEOUT_MS = 5000;
+
+// Longest single wait in callAndWait, bounds how late an abort or cancel from another thread is noticed
+static const int MAX_CALL_WAIT_SLICE_MS = 50;
+
+// Open a private system-bus connection, returns nullptr on failure
+static DBusConnection *openPrivateConnection()
+{
+    DBusError error;
+    dbus_error_init(&error);
+
+    DBusConnection *conn = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+    if (dbus_error_is_set(&error))
+    {
+        std::cerr << "[DbusConnection] Private Connection Error: " << error.message << std::endl;
+        dbus_error_free(&error);
+        return nullptr;
+    }
+
+    if (conn)
+    {
+        // A dropped private connection must not terminate the process
+        dbus_connection_set_exit_on_disconnect(conn, FALSE);
+    }
+    return conn;
+}
+
+// Close and release a private connection
+static void closePrivateConnection(DBusConnection *conn)
+{
+    dbus_connection_close(conn);
+    dbus_connection_unref(conn);
+}
+
 // Constructor: Initializes member variables
-DbusConnection::DbusConnection() : connection(nullptr)
+DbusConnection::DbusConnection()
+    : connection(nullptr), privateConnections(false), noReplySent(0), noReplyFailed(0),
+      defaultCallTimeoutMs(DEFAULT_CALL_TIMEOUT_MS), callCount(0), timeoutCount(0), cancelledCount(0), abortedCount(0),
+      nextSignalId(1)
 {
     std::cout << "[DbusConnection] Constructor called." << std::endl;
 }
@@ -10,7 +51,31 @@ DbusConnection::DbusConnection() : connection(nullptr)
 // Destructor: Cleans up D-Bus connection
 DbusConnection::~DbusConnection()
 {
+    for (DBusMessage *msg : deferredSignals)
+    {
+        dbus_message_unref(msg);
+    }
+    deferredSignals.clear();
+
     if (connection)
+    {
+        dbus_connection_remove_filter(connection, &DbusConnection::messageFilter, this);
+    }
+
+    for (DBusConnection *conn : bulkConnections)
+    {
+        dbus_connection_remove_filter(conn, &DbusConnection::messageFilter, this);
+        closePrivateConnection(conn);
+    }
+    bulkConnections.clear();
+
+    if (connection && privateConnections)
+    {
+        std::cout << "[DbusConnection] Closing private D-Bus connections." << std::endl;
+        closePrivateConnection(connection);
+        connection = nullptr;
+    }
+    else if (connection)
     {
         // Remove the call to dbus_connection_close(), as it should not be called on shared connections.
         std::cout << "[DbusConnection] Unreferencing D-Bus connection." << std::endl;
@@ -25,6 +90,9 @@ bool DbusConnection::initialize()
     DBusError error;
     dbus_error_init(&error);
 
+    // The connection is shared with background threads (GATT cache checks)
+    dbus_threads_init_default();
+
     // Connect to the system bus
     connection = dbus_bus_get(DBUS_BUS_SYSTEM, &error);
     if (dbus_error_is_set(&error))
@@ -40,9 +108,68 @@ bool DbusConnection::initialize()
         return false;
     }
 
+    installFilters();
+    return true;
+}
+
+// Initialize a pool of private D-Bus connections
+bool DbusConnection::initialize(int poolSize)
+{
+    if (poolSize <= 1)
+    {
+        return initialize();
+    }
+
+    // Connections of the pool are used from several threads
+    dbus_threads_init_default();
+
+    connection = openPrivateConnection();
+    if (!connection)
+    {
+        std::cerr << "[DbusConnection] Failed to open the control connection." << std::endl;
+        return false;
+    }
+    privateConnections = true;
+
+    for (int i = 1; i < poolSize; ++i)
+    {
+        DBusConnection *conn = openPrivateConnection();
+        if (!conn)
+        {
+            std::cerr << "[DbusConnection] Failed to open bulk connection " << i << "." << std::endl;
+            return false;
+        }
+        bulkConnections.push_back(conn);
+    }
+
+    installFilters();
+    std::cout << "[DbusConnection] Opened " << poolSize << " private connection(s)." << std::endl;
     return true;
 }
 
+// Pick a connection: control traffic stays on connection 0, bulk traffic of a
+// device always maps to the same bulk connection to keep its ordering
+DBusConnection *DbusConnection::getConnection(TrafficClass trafficClass, const std::string &devicePath) const
+{
+    if (trafficClass == TrafficClass::Control || bulkConnections.empty())
+    {
+        return connection;
+    }
+
+    size_t index = std::hash<std::string>()(devicePath) % bulkConnections.size();
+    return bulkConnections[index];
+}
+
+// Number of connections in the pool
+int DbusConnection::getPoolSize() const
+{
+    if (!connection)
+    {
+        return 0;
+    }
+    return 1 + static_cast<int>(bulkConnections.size());
+}
+
 // Create a method call message
 DBusMessage *DbusConnection::createMethodCall(const std::string &busName,
                                               const std::string &objectPath,
@@ -60,7 +187,7 @@ DBusMessage *DbusConnection::sendAndBlock(DBusMessage *msg)
     dbus_error_init(&error);
 
     // Send message and block until a reply is received
-    DBusMessage *reply = dbus_connection_send_with_reply_and_block(connection, msg, -1, &error);
+    DBusMessage *reply = sendAndBlock(msg, -1, &error);
 
     if (dbus_error_is_set(&error))
     {
@@ -72,6 +199,445 @@ DBusMessage *DbusConnection::sendAndBlock(DBusMessage *msg)
     return reply;
 }
 
+// Block on a call on the control connection, bounded by timeoutMs
+DBusMessage *DbusConnection::sendAndBlock(DBusMessage *msg, int timeoutMs, DBusError *error)
+{
+    callCount++;
+    DBusMessage *reply = dbus_connection_send_with_reply_and_block(connection, msg, timeoutMs < 0 ? defaultCallTimeoutMs.load() : timeoutMs, error);
+    if (!reply && dbus_error_has_name(error, DBUS_ERROR_NO_REPLY))
+    {
+        timeoutCount++;
+    }
+    return reply;
+}
+
+void DbusConnection::setDefaultCallTimeout(int timeoutMs)
+{
+    defaultCallTimeoutMs = timeoutMs > 0 ? timeoutMs : DEFAULT_CALL_TIMEOUT_MS;
+}
+
+int DbusConnection::getDefaultCallTimeout() const
+{
+    return defaultCallTimeoutMs;
+}
+
+// Send a method call and return once it is written, without waiting for the reply
+DBusPendingCall *DbusConnection::sendWithReply(DBusMessage *msg, DBusConnection *conn, int timeoutMs)
+{
+    DBusPendingCall *pending = nullptr;
+    if (!dbus_connection_send_with_reply(conn, msg, &pending, timeoutMs) || !pending)
+    {
+        std::cerr << "[DbusConnection] Error in sendWithReply: connection closed or out of memory." << std::endl;
+        return nullptr;
+    }
+    callCount++;
+
+    // Put the call on the wire now so it overlaps with whatever the caller does next
+    dbus_connection_flush(conn);
+    return pending;
+}
+
+// Send a call and wait for its reply while dispatching, so aborts are seen early
+DBusMessage *DbusConnection::callAndWait(DBusMessage *msg, DBusConnection *conn, int timeoutMs,
+                                         const std::string &callName, std::string *errorName,
+                                         const CancellationToken *cancel)
+{
+    int effectiveTimeoutMs = timeoutMs < 0 ? defaultCallTimeoutMs.load() : timeoutMs;
+    DBusPendingCall *pending = sendWithReply(msg, conn, effectiveTimeoutMs);
+    if (!pending)
+    {
+        return nullptr;
+    }
+
+    InFlightCall call;
+    const char *path = dbus_message_get_path(msg);
+    call.path = path ? path : "";
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        inFlightCalls.push_back(&call);
+    }
+
+    // libdbus only expires pending calls from a main loop or dbus_pending_call_block,
+    // so the deadline is enforced here
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(effectiveTimeoutMs);
+    std::string abortError;
+    while (!dbus_pending_call_get_completed(pending))
+    {
+        {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            abortError = call.abortError;
+        }
+        if (abortError.empty() && cancel && cancel->isCancelled())
+        {
+            abortError = CALL_CANCELLED_ERROR;
+        }
+        long long remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (!abortError.empty() || remainingMs <= 0)
+        {
+            break;
+        }
+
+        // Signals arrive on the control connection, keep it moving while waiting on a bulk one
+        int sliceMs = static_cast<int>(std::min<long long>(remainingMs, MAX_CALL_WAIT_SLICE_MS));
+        if (!dbus_connection_read_write_dispatch(conn, sliceMs))
+        {
+            break;
+        }
+        if (conn != connection)
+        {
+            dbus_connection_read_write_dispatch(connection, 0);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(inFlightMutex);
+        inFlightCalls.erase(std::remove(inFlightCalls.begin(), inFlightCalls.end(), &call), inFlightCalls.end());
+    }
+
+    if (!dbus_pending_call_get_completed(pending))
+    {
+        // Drop the call right away, a late reply is discarded by libdbus
+        dbus_pending_call_cancel(pending);
+        dbus_pending_call_unref(pending);
+        std::string reason;
+        if (abortError.empty())
+        {
+            timeoutCount++;
+            reason = "no reply within " + std::to_string(effectiveTimeoutMs) + " ms.";
+        }
+        else if (abortError == CALL_CANCELLED_ERROR)
+        {
+            cancelledCount++;
+            reason = "cancelled.";
+        }
+        else
+        {
+            abortedCount++;
+            reason = "aborted (" + abortError + ").";
+        }
+        std::string error = abortError.empty() ? DBUS_ERROR_NO_REPLY : abortError;
+        std::cerr << "[DbusConnection] " << callName << " failed: " << reason << std::endl;
+        if (errorName)
+        {
+            *errorName = error;
+        }
+        return nullptr;
+    }
+
+    return finishCall(pending, callName, errorName);
+}
+
+// Give up a pending call and release it at once
+void DbusConnection::cancelCall(DBusPendingCall *pending)
+{
+    if (!pending)
+    {
+        return;
+    }
+    dbus_pending_call_cancel(pending);
+    dbus_pending_call_unref(pending);
+    cancelledCount++;
+}
+
+// Fail the calls in flight below pathPrefix
+void DbusConnection::abortCalls(const std::string &pathPrefix, const std::string &errorName)
+{
+    std::lock_guard<std::mutex> lock(inFlightMutex);
+    for (InFlightCall *call : inFlightCalls)
+    {
+        if (call->path == pathPrefix ||
+            (call->path.size() > pathPrefix.size() && call->path.compare(0, pathPrefix.size(), pathPrefix) == 0 &&
+             call->path[pathPrefix.size()] == '/'))
+        {
+            call->abortError = errorName;
+        }
+    }
+}
+
+// Block until a pending call completes and take its reply
+DBusMessage *DbusConnection::finishCall(DBusPendingCall *pending, const std::string &callName, std::string *errorName)
+{
+    if (!pending)
+    {
+        return nullptr;
+    }
+
+    dbus_pending_call_block(pending);
+    DBusMessage *reply = dbus_pending_call_steal_reply(pending);
+    dbus_pending_call_unref(pending);
+
+    if (!reply)
+    {
+        std::cerr << "[DbusConnection] " << callName << " returned no reply." << std::endl;
+        return nullptr;
+    }
+
+    if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_ERROR)
+    {
+        DBusError error;
+        dbus_error_init(&error);
+        dbus_set_error_from_message(&error, reply);
+        std::cerr << "[DbusConnection] " << callName << " failed: "
+                  << (error.message ? error.message : dbus_message_get_error_name(reply)) << std::endl;
+        if (errorName)
+        {
+            *errorName = dbus_message_get_error_name(reply);
+        }
+        if (dbus_message_is_error(reply, DBUS_ERROR_NO_REPLY))
+        {
+            timeoutCount++;
+        }
+        dbus_error_free(&error);
+        dbus_message_unref(reply);
+        return nullptr;
+    }
+
+    return reply;
+}
+
+// Send a no-reply message and return as soon as it is queued on the socket
+bool DbusConnection::sendNoReply(DBusMessage *msg, DBusConnection *conn)
+{
+    dbus_message_set_no_reply(msg, TRUE);
+
+    if (!dbus_connection_send(conn, msg, nullptr))
+    {
+        std::cerr << "[DbusConnection] Error in sendNoReply: out of memory." << std::endl;
+        noReplyFailed++;
+        return false;
+    }
+
+    // The flush fails silently; a connection closed meanwhile means the message never left
+    dbus_connection_flush(conn);
+    if (!dbus_connection_get_is_connected(conn))
+    {
+        std::cerr << "[DbusConnection] Error in sendNoReply: connection closed." << std::endl;
+        noReplyFailed++;
+        return false;
+    }
+
+    noReplySent++;
+    return true;
+}
+
+// Read and dispatch whatever is already available on the connections
+void DbusConnection::dispatchPending()
+{
+    std::lock_guard<std::recursive_mutex> lock(dispatchMutex);
+    std::vector<DBusConnection *> all(bulkConnections);
+    if (connection)
+    {
+        all.push_back(connection);
+    }
+
+    for (DBusConnection *conn : all)
+    {
+        dbus_connection_read_write(conn, 0);
+        while (dbus_connection_dispatch(conn) == DBUS_DISPATCH_DATA_REMAINS)
+        {
+        }
+    }
+    runDeferredSignals();
+}
+
+std::recursive_mutex &DbusConnection::getDispatchMutex()
+{
+    return dispatchMutex;
+}
+
+// Route signals to the subscribed handlers. A thread waiting in callAndWait
+// while another one holds dispatchMutex only queues them, so handlers never
+// run on two threads at once.
+DBusHandlerResult DbusConnection::messageFilter(DBusConnection *, DBusMessage *msg, void *userData)
+{
+    DbusConnection *self = static_cast<DbusConnection *>(userData);
+
+    if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_SIGNAL)
+    {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    std::unique_lock<std::recursive_mutex> dispatchLock(self->dispatchMutex, std::try_to_lock);
+    if (!dispatchLock.owns_lock())
+    {
+        std::lock_guard<std::mutex> lock(self->signalMutex);
+        self->deferredSignals.push_back(dbus_message_ref(msg));
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    self->runDeferredSignals();
+    self->routeSignal(msg);
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+// Run the handlers of one signal
+void DbusConnection::routeSignal(DBusMessage *msg)
+{
+    // Copy the matching handlers so they can (un)subscribe while running
+    std::vector<SignalHandler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        for (const SignalSubscription &subscription : signalSubscriptions)
+        {
+            if (dbus_message_is_signal(msg, subscription.interfaceName.c_str(), subscription.memberName.c_str()))
+            {
+                handlers.push_back(subscription.handler);
+            }
+        }
+    }
+
+    for (const SignalHandler &handler : handlers)
+    {
+        handler(msg);
+    }
+}
+
+// Route the signals other threads queued, oldest first
+void DbusConnection::runDeferredSignals()
+{
+    while (true)
+    {
+        DBusMessage *msg;
+        {
+            std::lock_guard<std::mutex> lock(signalMutex);
+            if (deferredSignals.empty())
+            {
+                return;
+            }
+            msg = deferredSignals.front();
+            deferredSignals.pop_front();
+        }
+        routeSignal(msg);
+        dbus_message_unref(msg);
+    }
+}
+
+// Subscribe to a signal on the control connection
+int DbusConnection::addSignalHandler(const std::string &matchRule, const std::string &interfaceName,
+                                     const std::string &memberName, SignalHandler handler)
+{
+    if (!connection)
+    {
+        std::cerr << "[DbusConnection] Cannot subscribe to signals before initialize()." << std::endl;
+        return -1;
+    }
+
+    DBusError error;
+    dbus_error_init(&error);
+
+    dbus_bus_add_match(connection, matchRule.c_str(), &error);
+    if (dbus_error_is_set(&error))
+    {
+        std::cerr << "[DbusConnection] Failed to add match rule " << matchRule << ": " << error.message << std::endl;
+        dbus_error_free(&error);
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(signalMutex);
+    SignalSubscription subscription;
+    subscription.id = nextSignalId++;
+    subscription.matchRule = matchRule;
+    subscription.interfaceName = interfaceName;
+    subscription.memberName = memberName;
+    subscription.handler = handler;
+    signalSubscriptions.push_back(subscription);
+    return subscription.id;
+}
+
+// Unsubscribe a signal handler
+void DbusConnection::removeSignalHandler(int id)
+{
+    std::string matchRule;
+    {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        for (auto it = signalSubscriptions.begin(); it != signalSubscriptions.end(); ++it)
+        {
+            if (it->id == id)
+            {
+                matchRule = it->matchRule;
+                signalSubscriptions.erase(it);
+                break;
+            }
+        }
+    }
+
+    if (!matchRule.empty() && connection)
+    {
+        // No error argument: don't wait for the bus daemon's reply
+        dbus_bus_remove_match(connection, matchRule.c_str(), nullptr);
+    }
+}
+
+// Wait for incoming messages on the control connection and dispatch everything received
+bool DbusConnection::processEvents(int timeoutMs)
+{
+    if (!connection)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(dispatchMutex);
+    bool connected = dbus_connection_read_write_dispatch(connection, timeoutMs) != FALSE;
+    dispatchPending();
+    return connected;
+}
+
+// Wait on one connection of the pool, then dispatch what the others received
+bool DbusConnection::processEvents(int timeoutMs, DBusConnection *waitOn)
+{
+    if (!connection)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(dispatchMutex);
+    bool connected = dbus_connection_read_write_dispatch(waitOn ? waitOn : connection, timeoutMs) != FALSE;
+    dispatchPending();
+    return connected;
+}
+
+// Register the message filter on every connection
+void DbusConnection::installFilters()
+{
+    dbus_connection_add_filter(connection, &DbusConnection::messageFilter, this, nullptr);
+    for (DBusConnection *conn : bulkConnections)
+    {
+        dbus_connection_add_filter(conn, &DbusConnection::messageFilter, this, nullptr);
+    }
+}
+
+// Number of fire-and-forget messages sent
+unsigned long DbusConnection::getNoReplySentCount() const
+{
+    return noReplySent;
+}
+
+// Number of fire-and-forget messages that failed
+unsigned long DbusConnection::getNoReplyFailureCount() const
+{
+    return noReplyFailed;
+}
+
+unsigned long DbusConnection::getCallCount() const
+{
+    return callCount;
+}
+
+unsigned long DbusConnection::getTimeoutCount() const
+{
+    return timeoutCount;
+}
+
+unsigned long DbusConnection::getCancelledCount() const
+{
+    return cancelledCount;
+}
+
+unsigned long DbusConnection::getAbortedCount() const
+{
+    return abortedCount;
+}
+
 // Getter for the DBusConnection
 DBusConnection *DbusConnection::getConnection() const
 {
@@ -0,0 +1,309 @@
+// src/DeviceConfig.cpp
+
+#include "DeviceConfig.h"
+#include <cmath>
+#include <iostream>
+
+// ----------------------
+// Schema
+// ----------------------
+
+enum class FieldType : uint8_t
+{
+    UInt32,
+    Int8,
+    Enum, // One byte, index into enumNames
+};
+
+struct ConfigField
+{
+    ConfigKey key;
+    const char *asciiName;
+    FieldType type;
+    int64_t minValue;
+    int64_t maxValue;
+    const char *const *enumNames;
+};
+
+static constexpr const char *MODULATION_NAMES[] = {"OOK", "ASK", "FSK", "GFSK", "MSK"};
+static constexpr const char *ROLE_NAMES[] = {"Transmitter", "Receiver"};
+
+// One entry per ConfigKey, in tag order
+static constexpr ConfigField CONFIG_SCHEMA[] = {
+    {ConfigKey::Frequency, "FREQ", FieldType::UInt32, 300000, 928000, nullptr},
+    {ConfigKey::Modulation, "MOD", FieldType::Enum, 0, 4, MODULATION_NAMES},
+    {ConfigKey::Power, "PWR", FieldType::Int8, -30, 20, nullptr},
+    {ConfigKey::Role, "ROLE", FieldType::Enum, 0, 1, ROLE_NAMES},
+};
+
+static constexpr size_t valueSize(FieldType type)
+{
+    return type == FieldType::UInt32 ? 4 : 1;
+}
+
+// Entries match their tags and every range fits the encoded width
+static constexpr bool schemaIsValid()
+{
+    size_t index = 0;
+    for (const ConfigField &field : CONFIG_SCHEMA)
+    {
+        if (static_cast<size_t>(field.key) != index + 1 || field.minValue > field.maxValue)
+        {
+            return false;
+        }
+        if (field.type == FieldType::UInt32 && (field.minValue < 0 || field.maxValue > 0xFFFFFFFFLL))
+        {
+            return false;
+        }
+        if (field.type == FieldType::Int8 && (field.minValue < -128 || field.maxValue > 127))
+        {
+            return false;
+        }
+        if (field.type == FieldType::Enum && (field.enumNames == nullptr || field.minValue != 0 || field.maxValue > 255))
+        {
+            return false;
+        }
+        ++index;
+    }
+    return true;
+}
+
+static constexpr size_t maxTlvSize()
+{
+    size_t size = 0;
+    for (const ConfigField &field : CONFIG_SCHEMA)
+    {
+        size += 2 + valueSize(field.type);
+    }
+    return size;
+}
+
+static_assert(sizeof(CONFIG_SCHEMA) / sizeof(CONFIG_SCHEMA[0]) == CONFIG_KEY_COUNT, "Every ConfigKey needs a schema entry");
+static_assert(schemaIsValid(), "Config schema entries must be in tag order with ranges that fit their type");
+static_assert(maxTlvSize() <= MAX_CONFIG_PAYLOAD, "A full TLV configuration must fit in one ATT write");
+
+static const ConfigField *fieldFor(ConfigKey key)
+{
+    size_t index = static_cast<size_t>(key);
+    if (index == 0 || index > CONFIG_KEY_COUNT)
+    {
+        return nullptr;
+    }
+    return &CONFIG_SCHEMA[index - 1];
+}
+
+// "433.0", "433.92"
+static std::string formatMHz(int64_t kHz)
+{
+    std::string text = std::to_string(kHz / 1000) + ".";
+    std::string fraction = std::to_string(1000 + kHz % 1000).substr(1);
+    while (fraction.size() > 1 && fraction.back() == '0')
+    {
+        fraction.pop_back();
+    }
+    return text + fraction;
+}
+
+// ----------------------
+// DeviceConfig
+// ----------------------
+
+DeviceConfig::DeviceConfig()
+    : presentMask(0)
+{
+    for (size_t i = 0; i < CONFIG_KEY_COUNT; ++i)
+    {
+        values[i] = 0;
+    }
+}
+
+bool DeviceConfig::setFrequencyMHz(double frequencyMHz)
+{
+    return set(ConfigKey::Frequency, static_cast<int64_t>(std::llround(frequencyMHz * 1000.0)));
+}
+
+bool DeviceConfig::setModulation(Modulation modulation)
+{
+    return set(ConfigKey::Modulation, static_cast<int64_t>(modulation));
+}
+
+bool DeviceConfig::setPowerDbm(int powerDbm)
+{
+    return set(ConfigKey::Power, powerDbm);
+}
+
+bool DeviceConfig::setRole(RadioRole role)
+{
+    return set(ConfigKey::Role, static_cast<int64_t>(role));
+}
+
+// Set a value in schema units after checking its range
+bool DeviceConfig::set(ConfigKey key, int64_t value)
+{
+    const ConfigField *field = fieldFor(key);
+    if (!field)
+    {
+        std::cerr << "[DeviceConfig] Unknown config key " << static_cast<int>(key) << "." << std::endl;
+        return false;
+    }
+    if (value < field->minValue || value > field->maxValue)
+    {
+        std::cerr << "[DeviceConfig] " << field->asciiName << " value " << value << " is outside ["
+                  << field->minValue << ", " << field->maxValue << "]." << std::endl;
+        return false;
+    }
+
+    size_t index = static_cast<size_t>(key) - 1;
+    values[index] = value;
+    presentMask |= 1u << index;
+    return true;
+}
+
+bool DeviceConfig::has(ConfigKey key) const
+{
+    return fieldFor(key) && (presentMask & (1u << (static_cast<size_t>(key) - 1))) != 0;
+}
+
+int64_t DeviceConfig::get(ConfigKey key) const
+{
+    return has(key) ? values[static_cast<size_t>(key) - 1] : 0;
+}
+
+void DeviceConfig::unset(ConfigKey key)
+{
+    if (fieldFor(key))
+    {
+        presentMask &= ~(1u << (static_cast<size_t>(key) - 1));
+    }
+}
+
+bool DeviceConfig::empty() const
+{
+    return presentMask == 0;
+}
+
+size_t DeviceConfig::size() const
+{
+    size_t count = 0;
+    for (uint32_t mask = presentMask; mask; mask &= mask - 1)
+    {
+        ++count;
+    }
+    return count;
+}
+
+// Keys that differ from applied
+DeviceConfig DeviceConfig::changedFrom(const DeviceConfig &applied) const
+{
+    DeviceConfig delta;
+    for (const ConfigField &field : CONFIG_SCHEMA)
+    {
+        if (has(field.key) && (!applied.has(field.key) || applied.get(field.key) != get(field.key)))
+        {
+            delta.set(field.key, get(field.key));
+        }
+    }
+    return delta;
+}
+
+// Copy the keys set in other
+void DeviceConfig::merge(const DeviceConfig &other)
+{
+    for (const ConfigField &field : CONFIG_SCHEMA)
+    {
+        if (other.has(field.key))
+        {
+            set(field.key, other.get(field.key));
+        }
+    }
+}
+
+// Encode the keys that are set
+bool DeviceConfig::encode(ConfigEncoding encoding, std::string &payload) const
+{
+    payload.clear();
+
+    for (const ConfigField &field : CONFIG_SCHEMA)
+    {
+        if (!has(field.key))
+        {
+            continue;
+        }
+        int64_t value = get(field.key);
+
+        if (encoding == ConfigEncoding::LegacyAscii)
+        {
+            payload += field.asciiName;
+            payload += ':';
+            if (field.key == ConfigKey::Frequency)
+            {
+                payload += formatMHz(value);
+            }
+            else if (field.type == FieldType::Enum)
+            {
+                payload += field.enumNames[value];
+            }
+            else
+            {
+                payload += std::to_string(value);
+            }
+            payload += ';';
+            continue;
+        }
+
+        size_t size = valueSize(field.type);
+        payload += static_cast<char>(field.key);
+        payload += static_cast<char>(size);
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < size; ++i)
+        {
+            payload += static_cast<char>((bits >> (8 * i)) & 0xFF);
+        }
+    }
+
+    if (encoding == ConfigEncoding::Tlv && payload.size() > MAX_CONFIG_PAYLOAD)
+    {
+        std::cerr << "[DeviceConfig] TLV payload of " << payload.size() << " bytes exceeds "
+                  << MAX_CONFIG_PAYLOAD << " bytes." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Decode a TLV payload
+bool DeviceConfig::decodeTlv(const std::string &payload, DeviceConfig &config)
+{
+    config = DeviceConfig();
+
+    size_t pos = 0;
+    while (pos < payload.size())
+    {
+        if (pos + 2 > payload.size())
+        {
+            return false;
+        }
+        ConfigKey key = static_cast<ConfigKey>(static_cast<uint8_t>(payload[pos]));
+        size_t size = static_cast<uint8_t>(payload[pos + 1]);
+        pos += 2;
+
+        const ConfigField *field = fieldFor(key);
+        if (!field || size != valueSize(field->type) || pos + size > payload.size())
+        {
+            return false;
+        }
+
+        uint64_t bits = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(payload[pos + i])) << (8 * i);
+        }
+        pos += size;
+
+        int64_t value = field->type == FieldType::Int8 ? static_cast<int8_t>(bits) : static_cast<int64_t>(bits);
+        if (!config.set(key, value))
+        {
+            return false;
+        }
+    }
+    return true;
+}
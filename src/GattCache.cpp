@@ -0,0 +1,382 @@
+// src/GattCache.cpp
+
+#include "GattCache.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ----------------------
+// On-disk layout
+// ----------------------
+
+static const char CACHE_MAGIC[8] = {'B', 'L', 'E', 'G', 'A', 'T', 'T', '1'};
+static const uint32_t CACHE_VERSION = 2;
+static const size_t MAX_CACHED_CHARACTERISTICS = 32;
+static const size_t INITIAL_ENTRY_CAPACITY = 16;
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCapacity;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct CacheCharacteristic
+{
+    char uuid[40];
+    char serviceUuid[40];
+    char path[128];
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct CacheEntry
+{
+    char macAddress[24];
+    uint64_t layoutHash;
+    uint32_t characteristicCount;
+    uint32_t reserved;
+    CacheCharacteristic characteristics[MAX_CACHED_CHARACTERISTICS];
+};
+
+static size_t fileSizeFor(size_t entryCapacity)
+{
+    return sizeof(CacheHeader) + entryCapacity * sizeof(CacheEntry);
+}
+
+static std::string normalizeMac(const std::string &macAddress)
+{
+    std::string mac = macAddress;
+    std::transform(mac.begin(), mac.end(), mac.begin(),
+                   [](unsigned char c)
+                   { return std::toupper(c); });
+    return mac;
+}
+
+// Copy a string into a fixed field, refusing values that don't fit
+static bool copyField(char *field, size_t fieldSize, const std::string &value)
+{
+    if (value.size() >= fieldSize)
+    {
+        return false;
+    }
+    std::memset(field, 0, fieldSize);
+    std::memcpy(field, value.data(), value.size());
+    return true;
+}
+
+// Read the header and check it describes a file of this size, so no lookup
+// can walk past the end of the mapping
+static bool readValidHeader(int fd, CacheHeader &header)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CacheHeader))
+    {
+        return false;
+    }
+
+    return pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+           std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+           header.version == CACHE_VERSION &&
+           header.entryCapacity > 0 &&
+           header.entryCount <= header.entryCapacity &&
+           static_cast<size_t>(st.st_size) >= fileSizeFor(header.entryCapacity);
+}
+
+// Advisory lock on the cache file for the duration of one operation, so
+// processes sharing the file don't interleave their updates
+class CacheFileLock
+{
+public:
+    CacheFileLock(int fd_, int operation)
+        : fd(fd_), locked(flock(fd_, operation) == 0)
+    {
+    }
+
+    ~CacheFileLock()
+    {
+        if (locked)
+        {
+            flock(fd, LOCK_UN);
+        }
+    }
+
+    bool isLocked() const
+    {
+        return locked;
+    }
+
+private:
+    int fd;
+    bool locked;
+};
+
+// ----------------------
+// GattCache
+// ----------------------
+
+GattCache::GattCache(const std::string &filePath_)
+    : filePath(filePath_), fd(-1), mapping(nullptr), mappingSize(0)
+{
+}
+
+GattCache::~GattCache()
+{
+    unmapFile();
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+// Map the cache file, creating or resetting it when it is missing or invalid
+bool GattCache::open()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    fd = ::open(filePath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "[GattCache] Failed to open cache file " << filePath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    CacheFileLock fileLock(fd, LOCK_EX);
+    if (!fileLock.isLocked())
+    {
+        std::cerr << "[GattCache] Failed to lock cache file " << filePath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    CacheHeader header;
+    if (!readValidHeader(fd, header))
+    {
+        return resetFile();
+    }
+    return mapFile(header.entryCapacity);
+}
+
+// Recreate an empty cache and map it, the file lock must be held exclusively
+bool GattCache::resetFile()
+{
+    unmapFile();
+    std::cout << "[GattCache] Creating cache file " << filePath << "." << std::endl;
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, fileSizeFor(INITIAL_ENTRY_CAPACITY)) != 0)
+    {
+        std::cerr << "[GattCache] Failed to size cache file " << filePath << "." << std::endl;
+        return false;
+    }
+
+    if (!mapFile(INITIAL_ENTRY_CAPACITY))
+    {
+        return false;
+    }
+
+    CacheHeader *header = static_cast<CacheHeader *>(mapping);
+    std::memcpy(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header->version = CACHE_VERSION;
+    header->entryCapacity = static_cast<uint32_t>(INITIAL_ENTRY_CAPACITY);
+    header->entryCount = 0;
+    return true;
+}
+
+// Follow changes another process made to the file (growth, reset) before
+// touching the mapping; the file lock must be held
+bool GattCache::syncMapping()
+{
+    CacheHeader header;
+    if (!readValidHeader(fd, header))
+    {
+        unmapFile();
+        return false;
+    }
+
+    if (!mapping || mappingSize != fileSizeFor(header.entryCapacity))
+    {
+        unmapFile();
+        return mapFile(header.entryCapacity);
+    }
+    return true;
+}
+
+bool GattCache::mapFile(size_t entryCapacity)
+{
+    size_t size = fileSizeFor(entryCapacity);
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        std::cerr << "[GattCache] Failed to map cache file " << filePath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    mapping = addr;
+    mappingSize = size;
+    return true;
+}
+
+void GattCache::unmapFile()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+}
+
+// Copy the cached table of a device
+bool GattCache::lookup(const std::string &macAddress, uint64_t &layoutHash,
+                       std::vector<CachedCharacteristic> &characteristics)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    CacheFileLock fileLock(fd, LOCK_SH);
+    if (!fileLock.isLocked() || !syncMapping())
+    {
+        return false;
+    }
+
+    std::string mac = normalizeMac(macAddress);
+    CacheHeader *header = static_cast<CacheHeader *>(mapping);
+    CacheEntry *entries = reinterpret_cast<CacheEntry *>(header + 1);
+
+    for (uint32_t i = 0; i < header->entryCount; ++i)
+    {
+        CacheEntry &entry = entries[i];
+        if (std::strncmp(entry.macAddress, mac.c_str(), sizeof(entry.macAddress)) != 0)
+        {
+            continue;
+        }
+
+        layoutHash = entry.layoutHash;
+        characteristics.clear();
+        uint32_t count = std::min<uint32_t>(entry.characteristicCount, MAX_CACHED_CHARACTERISTICS);
+        for (uint32_t c = 0; c < count; ++c)
+        {
+            CachedCharacteristic characteristic;
+            characteristic.uuid.assign(entry.characteristics[c].uuid, strnlen(entry.characteristics[c].uuid, sizeof(entry.characteristics[c].uuid)));
+            characteristic.path.assign(entry.characteristics[c].path, strnlen(entry.characteristics[c].path, sizeof(entry.characteristics[c].path)));
+            characteristic.serviceUuid.assign(entry.characteristics[c].serviceUuid, strnlen(entry.characteristics[c].serviceUuid, sizeof(entry.characteristics[c].serviceUuid)));
+            characteristic.flags = entry.characteristics[c].flags;
+            characteristics.push_back(characteristic);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Insert or replace the table of a device, growing the file when full
+bool GattCache::store(const std::string &macAddress, uint64_t layoutHash,
+                      const std::vector<CachedCharacteristic> &characteristics)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // A file another process left corrupt is rebuilt
+    CacheFileLock fileLock(fd, LOCK_EX);
+    if (!fileLock.isLocked() || (!syncMapping() && !resetFile()))
+    {
+        return false;
+    }
+
+    if (characteristics.size() > MAX_CACHED_CHARACTERISTICS)
+    {
+        std::cerr << "[GattCache] Layout of " << macAddress << " has too many characteristics to cache." << std::endl;
+        return false;
+    }
+
+    std::string mac = normalizeMac(macAddress);
+    CacheHeader *header = static_cast<CacheHeader *>(mapping);
+    CacheEntry *entries = reinterpret_cast<CacheEntry *>(header + 1);
+
+    uint32_t index = 0;
+    while (index < header->entryCount &&
+           std::strncmp(entries[index].macAddress, mac.c_str(), sizeof(entries[index].macAddress)) != 0)
+    {
+        ++index;
+    }
+
+    if (index == header->entryCount && header->entryCount == header->entryCapacity)
+    {
+        size_t newCapacity = header->entryCapacity * 2;
+        unmapFile();
+        if (ftruncate(fd, fileSizeFor(newCapacity)) != 0 || !mapFile(newCapacity))
+        {
+            std::cerr << "[GattCache] Failed to grow cache file " << filePath << "." << std::endl;
+            return false;
+        }
+        header = static_cast<CacheHeader *>(mapping);
+        entries = reinterpret_cast<CacheEntry *>(header + 1);
+        header->entryCapacity = static_cast<uint32_t>(newCapacity);
+    }
+
+    CacheEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    if (!copyField(entry.macAddress, sizeof(entry.macAddress), mac))
+    {
+        return false;
+    }
+    entry.layoutHash = layoutHash;
+    entry.characteristicCount = static_cast<uint32_t>(characteristics.size());
+    for (size_t c = 0; c < characteristics.size(); ++c)
+    {
+        if (!copyField(entry.characteristics[c].uuid, sizeof(entry.characteristics[c].uuid), characteristics[c].uuid) ||
+            !copyField(entry.characteristics[c].path, sizeof(entry.characteristics[c].path), characteristics[c].path) ||
+            !copyField(entry.characteristics[c].serviceUuid, sizeof(entry.characteristics[c].serviceUuid), characteristics[c].serviceUuid))
+        {
+            std::cerr << "[GattCache] Characteristic " << characteristics[c].path << " does not fit in the cache." << std::endl;
+            return false;
+        }
+        entry.characteristics[c].flags = characteristics[c].flags;
+    }
+
+    entries[index] = entry;
+    if (index == header->entryCount)
+    {
+        header->entryCount++;
+    }
+
+    msync(mapping, mappingSize, MS_ASYNC);
+    return true;
+}
+
+// FNV-1a over the sorted (path, uuid) pairs
+uint64_t GattCache::computeLayoutHash(const std::vector<CachedCharacteristic> &characteristics)
+{
+    std::vector<std::string> keys;
+    keys.reserve(characteristics.size());
+    for (const CachedCharacteristic &characteristic : characteristics)
+    {
+        keys.push_back(characteristic.path + "=" + characteristic.uuid);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    uint64_t hash = 1469598103934665603ULL;
+    for (const std::string &key : keys)
+    {
+        for (unsigned char c : key)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
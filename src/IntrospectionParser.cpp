@@ -0,0 +1,259 @@
+// src/IntrospectionParser.cpp
+
+#include "IntrospectionParser.h"
+#include <cstring>
+
+// ----------------------
+// StringView
+// ----------------------
+
+std::string StringView::str() const
+{
+    return std::string(data, size);
+}
+
+bool StringView::equals(const char *other) const
+{
+    size_t otherSize = std::strlen(other);
+    return otherSize == size && std::memcmp(data, other, size) == 0;
+}
+
+bool StringView::startsWith(const char *prefix) const
+{
+    size_t prefixSize = std::strlen(prefix);
+    return prefixSize <= size && std::memcmp(data, prefix, prefixSize) == 0;
+}
+
+// ----------------------
+// Tokenizer helpers
+// ----------------------
+
+static bool isNameChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '-' || c == ':' || c == '.';
+}
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Find a NUL-free pattern in [pos, end), returns end when missing
+static const char *findPattern(const char *pos, const char *end, const char *pattern)
+{
+    size_t patternSize = std::strlen(pattern);
+    while (pos + patternSize <= end)
+    {
+        const char *hit = static_cast<const char *>(std::memchr(pos, pattern[0], end - pos));
+        if (!hit || hit + patternSize > end)
+        {
+            return end;
+        }
+        if (std::memcmp(hit, pattern, patternSize) == 0)
+        {
+            return hit;
+        }
+        pos = hit + 1;
+    }
+    return end;
+}
+
+// ----------------------
+// IntrospectionParser
+// ----------------------
+
+// Stream elements to the handler in one pass over the buffer
+bool IntrospectionParser::parse(const char *xml, size_t length, IntrospectionHandler &handler)
+{
+    const char *pos = xml;
+    const char *end = xml + length;
+    int depth = 0;
+
+    while (pos < end)
+    {
+        const char *lt = static_cast<const char *>(std::memchr(pos, '<', end - pos));
+        if (!lt)
+        {
+            break;
+        }
+        pos = lt + 1;
+
+        // Comments, DOCTYPE and processing instructions carry no elements
+        if (pos < end && *pos == '!' && end - pos >= 3 && pos[1] == '-' && pos[2] == '-')
+        {
+            const char *close = findPattern(pos + 3, end, "-->");
+            if (close == end)
+            {
+                return false;
+            }
+            pos = close + 3;
+            continue;
+        }
+        if (pos < end && (*pos == '!' || *pos == '?'))
+        {
+            const char *close = static_cast<const char *>(std::memchr(pos, '>', end - pos));
+            if (!close)
+            {
+                return false;
+            }
+            pos = close + 1;
+            continue;
+        }
+
+        bool closing = pos < end && *pos == '/';
+        if (closing)
+        {
+            ++pos;
+        }
+
+        StringView tag = {pos, 0};
+        while (pos < end && isNameChar(*pos))
+        {
+            ++pos;
+        }
+        tag.size = pos - tag.data;
+        if (tag.size == 0)
+        {
+            return false;
+        }
+
+        if (closing)
+        {
+            const char *close = static_cast<const char *>(std::memchr(pos, '>', end - pos));
+            if (!close || depth == 0)
+            {
+                return false;
+            }
+            pos = close + 1;
+            --depth;
+            handler.onEndElement(tag, depth);
+            continue;
+        }
+
+        // Attributes, only "name" is reported
+        StringView name = {pos, 0};
+        bool selfClosing = false;
+        bool terminated = false;
+        while (pos < end)
+        {
+            while (pos < end && isSpace(*pos))
+            {
+                ++pos;
+            }
+            if (pos >= end)
+            {
+                break;
+            }
+            if (*pos == '>')
+            {
+                ++pos;
+                terminated = true;
+                break;
+            }
+            if (*pos == '/' && pos + 1 < end && pos[1] == '>')
+            {
+                pos += 2;
+                selfClosing = true;
+                terminated = true;
+                break;
+            }
+
+            StringView attr = {pos, 0};
+            while (pos < end && isNameChar(*pos))
+            {
+                ++pos;
+            }
+            attr.size = pos - attr.data;
+            if (attr.size == 0 || pos + 2 > end || *pos != '=' || (pos[1] != '"' && pos[1] != '\''))
+            {
+                return false;
+            }
+
+            char quote = pos[1];
+            const char *valueStart = pos + 2;
+            const char *valueEnd = static_cast<const char *>(std::memchr(valueStart, quote, end - valueStart));
+            if (!valueEnd)
+            {
+                return false;
+            }
+            if (attr.equals("name"))
+            {
+                name.data = valueStart;
+                name.size = valueEnd - valueStart;
+            }
+            pos = valueEnd + 1;
+        }
+
+        if (!terminated)
+        {
+            return false;
+        }
+
+        handler.onStartElement(tag, name, depth);
+        if (selfClosing)
+        {
+            handler.onEndElement(tag, depth);
+        }
+        else
+        {
+            ++depth;
+        }
+    }
+
+    return depth == 0;
+}
+
+// Handler keeping the root interfaces and the direct children
+class NodeCollector : public IntrospectionHandler
+{
+public:
+    NodeCollector(std::vector<StringView> &rootInterfaces_, std::vector<IntrospectedNode> &children_)
+        : rootInterfaces(rootInterfaces_), children(children_), inChild(false)
+    {
+    }
+
+    void onStartElement(const StringView &tag, const StringView &name, int depth) override
+    {
+        if (depth == 1 && tag.equals("node") && name.size > 0)
+        {
+            IntrospectedNode child;
+            child.name = name;
+            children.push_back(child);
+            inChild = true;
+        }
+        else if (depth == 1 && tag.equals("interface"))
+        {
+            rootInterfaces.push_back(name);
+        }
+        else if (depth == 2 && inChild && tag.equals("interface"))
+        {
+            children.back().interfaces.push_back(name);
+        }
+    }
+
+    void onEndElement(const StringView &tag, int depth) override
+    {
+        if (depth == 1 && tag.equals("node"))
+        {
+            inChild = false;
+        }
+    }
+
+private:
+    std::vector<StringView> &rootInterfaces;
+    std::vector<IntrospectedNode> &children;
+    bool inChild;
+};
+
+// Collect the interfaces of the root node and its direct children
+bool IntrospectionParser::parseNode(const char *xml, size_t length,
+                                    std::vector<StringView> &rootInterfaces,
+                                    std::vector<IntrospectedNode> &children)
+{
+    rootInterfaces.clear();
+    children.clear();
+
+    NodeCollector collector(rootInterfaces, children);
+    return parse(xml, length, collector);
+}
@@ -0,0 +1,165 @@
+// src/LogStreamParser.cpp
+
+#include "LogStreamParser.h"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Find the next '\n' in [pos, end), returns end when missing
+static const char *findNewline(const char *pos, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - pos >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask)
+        {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+#endif
+    const char *hit = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+    return hit ? hit : end;
+}
+
+LogStreamParser::LogStreamParser(LogRecordHandler handler_, size_t maxRecordLength_)
+    : handler(handler_), maxRecordLength(maxRecordLength_), discarding(false),
+      recordCount(0), malformedCount(0), overflowCount(0), byteCount(0)
+{
+    carry.reserve(maxRecordLength);
+}
+
+// Parse the next chunk of the stream
+void LogStreamParser::feed(const char *data, size_t length)
+{
+    const char *pos = data;
+    const char *end = data + length;
+    byteCount += length;
+
+    // Finish the record started by earlier chunks
+    if (discarding || !carry.empty())
+    {
+        const char *newline = findNewline(pos, end);
+        if (newline == end)
+        {
+            appendCarry(pos, end - pos);
+            return;
+        }
+
+        // May start discarding when the record turns out too long
+        appendCarry(pos, newline - pos);
+        if (!discarding)
+        {
+            emitRecord(carry.data(), carry.size());
+        }
+        carry.clear();
+        discarding = false;
+        pos = newline + 1;
+    }
+
+    // Complete records are emitted without copying
+    while (pos < end)
+    {
+        const char *newline = findNewline(pos, end);
+        if (newline == end)
+        {
+            break;
+        }
+        emitRecord(pos, newline - pos);
+        pos = newline + 1;
+    }
+
+    appendCarry(pos, end - pos);
+}
+
+// Drop a partially received record
+void LogStreamParser::reset()
+{
+    carry.clear();
+    discarding = false;
+}
+
+// Keep the unfinished tail of a chunk, dropping records that grow too long
+void LogStreamParser::appendCarry(const char *data, size_t length)
+{
+    if (discarding || length == 0)
+    {
+        return;
+    }
+    if (carry.size() + length > maxRecordLength)
+    {
+        carry.clear();
+        discarding = true;
+        overflowCount++;
+        return;
+    }
+    carry.insert(carry.end(), data, data + length);
+}
+
+// Split one record into its four fields
+void LogStreamParser::emitRecord(const char *data, size_t length)
+{
+    if (length > 0 && data[length - 1] == '\r')
+    {
+        --length;
+    }
+    if (length == 0)
+    {
+        return;
+    }
+    if (length > maxRecordLength)
+    {
+        overflowCount++;
+        return;
+    }
+
+    StringView fields[3];
+    const char *pos = data;
+    const char *end = data + length;
+    for (int i = 0; i < 3; ++i)
+    {
+        const char *separator = static_cast<const char *>(std::memchr(pos, '|', end - pos));
+        if (!separator)
+        {
+            malformedCount++;
+            return;
+        }
+        fields[i].data = pos;
+        fields[i].size = separator - pos;
+        pos = separator + 1;
+    }
+
+    LogRecord record;
+    record.timestamp = fields[0];
+    record.level = fields[1];
+    record.source = fields[2];
+    record.message.data = pos;
+    record.message.size = end - pos;
+
+    recordCount++;
+    handler(record);
+}
+
+unsigned long LogStreamParser::getRecordCount() const
+{
+    return recordCount;
+}
+
+unsigned long LogStreamParser::getMalformedCount() const
+{
+    return malformedCount;
+}
+
+unsigned long LogStreamParser::getOverflowCount() const
+{
+    return overflowCount;
+}
+
+unsigned long long LogStreamParser::getByteCount() const
+{
+    return byteCount;
+}
@@ -0,0 +1,371 @@
+// src/ObjectTree.cpp
+
+#include "ObjectTree.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static const char *const EMPTY_STRING = "";
+
+// ----------------------
+// Arena
+// ----------------------
+
+Arena::Arena(size_t blockSize_)
+    : blockSize(blockSize_), offset(0), totalUsed(0)
+{
+}
+
+Arena::~Arena()
+{
+    for (char *block : blocks)
+    {
+        std::free(block);
+    }
+}
+
+// Hand out size bytes from the current block, opening a new block when needed
+char *Arena::allocate(size_t size)
+{
+    if (blocks.empty() || offset + size > blockSize)
+    {
+        size_t newBlockSize = size > blockSize ? size : blockSize;
+        char *block = static_cast<char *>(std::malloc(newBlockSize));
+        if (!block)
+        {
+            return nullptr;
+        }
+
+        // Oversized allocations get their own block, inserted before the current one
+        if (newBlockSize > blockSize && !blocks.empty())
+        {
+            blocks.insert(blocks.end() - 1, block);
+            totalUsed += size;
+            return block;
+        }
+
+        blocks.push_back(block);
+        offset = 0;
+    }
+
+    char *ptr = blocks.back() + offset;
+    offset += size;
+    totalUsed += size;
+    return ptr;
+}
+
+// Copy a NUL-terminated string into the arena
+const char *Arena::copyString(const char *str)
+{
+    size_t length = std::strlen(str) + 1;
+    char *copy = allocate(length);
+    if (!copy)
+    {
+        return EMPTY_STRING;
+    }
+    std::memcpy(copy, str, length);
+    return copy;
+}
+
+// Free every block except the first one
+void Arena::reset()
+{
+    for (size_t i = 1; i < blocks.size(); ++i)
+    {
+        std::free(blocks[i]);
+    }
+    if (blocks.size() > 1)
+    {
+        blocks.resize(1);
+    }
+    offset = 0;
+    totalUsed = 0;
+}
+
+size_t Arena::bytesUsed() const
+{
+    return totalUsed;
+}
+
+// ----------------------
+// Property helpers
+// ----------------------
+
+// Walk an a{sv} dictionary, calling handler(name, variantIter) for each entry
+template <typename Handler>
+static void forEachProperty(DBusMessageIter *propsIter, Handler handler)
+{
+    DBusMessageIter arrayIter;
+    dbus_message_iter_recurse(propsIter, &arrayIter);
+    while (dbus_message_iter_get_arg_type(&arrayIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter entryIter;
+        dbus_message_iter_recurse(&arrayIter, &entryIter);
+
+        const char *name;
+        dbus_message_iter_get_basic(&entryIter, &name);
+        dbus_message_iter_next(&entryIter);
+
+        DBusMessageIter variantIter;
+        dbus_message_iter_recurse(&entryIter, &variantIter);
+        handler(name, &variantIter);
+
+        dbus_message_iter_next(&arrayIter);
+    }
+}
+
+// Copy a string or object path variant into the arena
+static const char *readString(Arena &arena, DBusMessageIter *variantIter)
+{
+    int type = dbus_message_iter_get_arg_type(variantIter);
+    if (type != DBUS_TYPE_STRING && type != DBUS_TYPE_OBJECT_PATH)
+    {
+        return EMPTY_STRING;
+    }
+
+    const char *str;
+    dbus_message_iter_get_basic(variantIter, &str);
+    return arena.copyString(str);
+}
+
+// Read a boolean variant
+static bool readBool(DBusMessageIter *variantIter)
+{
+    if (dbus_message_iter_get_arg_type(variantIter) != DBUS_TYPE_BOOLEAN)
+    {
+        return false;
+    }
+
+    dbus_bool_t value;
+    dbus_message_iter_get_basic(variantIter, &value);
+    return value != FALSE;
+}
+
+// Turn the Flags string array into a bitmask without copying the strings
+static uint32_t readFlags(DBusMessageIter *variantIter)
+{
+    uint32_t flags = 0;
+    if (dbus_message_iter_get_arg_type(variantIter) != DBUS_TYPE_ARRAY)
+    {
+        return flags;
+    }
+
+    DBusMessageIter arrayIter;
+    dbus_message_iter_recurse(variantIter, &arrayIter);
+    while (dbus_message_iter_get_arg_type(&arrayIter) == DBUS_TYPE_STRING)
+    {
+        const char *flag;
+        dbus_message_iter_get_basic(&arrayIter, &flag);
+
+        if (std::strcmp(flag, "read") == 0)
+            flags |= CHAR_FLAG_READ;
+        else if (std::strcmp(flag, "write") == 0)
+            flags |= CHAR_FLAG_WRITE;
+        else if (std::strcmp(flag, "write-without-response") == 0)
+            flags |= CHAR_FLAG_WRITE_WITHOUT_RESPONSE;
+        else if (std::strcmp(flag, "notify") == 0)
+            flags |= CHAR_FLAG_NOTIFY;
+        else if (std::strcmp(flag, "indicate") == 0)
+            flags |= CHAR_FLAG_INDICATE;
+
+        dbus_message_iter_next(&arrayIter);
+    }
+    return flags;
+}
+
+// ----------------------
+// ObjectTree
+// ----------------------
+
+ObjectTree::ObjectTree()
+{
+}
+
+ObjectTree::~ObjectTree()
+{
+}
+
+// Call GetManagedObjects on org.bluez and parse the reply
+bool ObjectTree::refresh(DbusConnection &dbusConn)
+{
+    DBusMessage *msg = dbus_message_new_method_call(
+        "org.bluez", "/", "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+
+    if (!msg)
+    {
+        std::cerr << "[ObjectTree] Failed to create GetManagedObjects message." << std::endl;
+        return false;
+    }
+
+    DBusError err;
+    dbus_error_init(&err);
+
+    DBusMessage *reply = dbusConn.sendAndBlock(msg, -1, &err);
+    dbus_message_unref(msg);
+
+    if (!reply)
+    {
+        if (dbus_error_is_set(&err))
+        {
+            std::cerr << "[ObjectTree] GetManagedObjects call failed: " << err.message << std::endl;
+            dbus_error_free(&err);
+        }
+        else
+        {
+            std::cerr << "[ObjectTree] GetManagedObjects call failed: Unknown error." << std::endl;
+        }
+        return false;
+    }
+
+    bool ok = parse(reply);
+    dbus_message_unref(reply);
+    return ok;
+}
+
+// Walk the a{oa{sa{sv}}} reply once
+bool ObjectTree::parse(DBusMessage *reply)
+{
+    clear();
+
+    if (std::strcmp(dbus_message_get_signature(reply), "a{oa{sa{sv}}}") != 0)
+    {
+        std::cerr << "[ObjectTree] Unexpected GetManagedObjects signature: " << dbus_message_get_signature(reply) << std::endl;
+        return false;
+    }
+
+    DBusMessageIter iter;
+    dbus_message_iter_init(reply, &iter);
+
+    DBusMessageIter objectsIter;
+    dbus_message_iter_recurse(&iter, &objectsIter);
+    while (dbus_message_iter_get_arg_type(&objectsIter) == DBUS_TYPE_DICT_ENTRY)
+    {
+        DBusMessageIter objectIter;
+        dbus_message_iter_recurse(&objectsIter, &objectIter);
+
+        const char *path;
+        dbus_message_iter_get_basic(&objectIter, &path);
+        dbus_message_iter_next(&objectIter);
+
+        DBusMessageIter ifacesIter;
+        dbus_message_iter_recurse(&objectIter, &ifacesIter);
+        while (dbus_message_iter_get_arg_type(&ifacesIter) == DBUS_TYPE_DICT_ENTRY)
+        {
+            DBusMessageIter ifaceIter;
+            dbus_message_iter_recurse(&ifacesIter, &ifaceIter);
+
+            const char *iface;
+            dbus_message_iter_get_basic(&ifaceIter, &iface);
+            dbus_message_iter_next(&ifaceIter);
+
+            // Interfaces we don't use are skipped without being decoded
+            if (std::strcmp(iface, "org.bluez.GattCharacteristic1") == 0)
+                parseCharacteristic(&ifaceIter, path);
+            else if (std::strcmp(iface, "org.bluez.GattService1") == 0)
+                parseService(&ifaceIter, path);
+            else if (std::strcmp(iface, "org.bluez.Device1") == 0)
+                parseDevice(&ifaceIter, path);
+            else if (std::strcmp(iface, "org.bluez.Adapter1") == 0)
+                parseAdapter(&ifaceIter, path);
+
+            dbus_message_iter_next(&ifacesIter);
+        }
+
+        dbus_message_iter_next(&objectsIter);
+    }
+
+    return true;
+}
+
+void ObjectTree::parseAdapter(DBusMessageIter *propsIter, const char *path)
+{
+    ManagedAdapter adapter = {arena.copyString(path), EMPTY_STRING, false};
+    forEachProperty(propsIter, [&](const char *name, DBusMessageIter *value)
+                    {
+        if (std::strcmp(name, "Address") == 0)
+            adapter.address = readString(arena, value);
+        else if (std::strcmp(name, "Powered") == 0)
+            adapter.powered = readBool(value); });
+    adapters.push_back(adapter);
+}
+
+void ObjectTree::parseDevice(DBusMessageIter *propsIter, const char *path)
+{
+    ManagedDevice device = {arena.copyString(path), EMPTY_STRING, EMPTY_STRING, EMPTY_STRING, false, false};
+    forEachProperty(propsIter, [&](const char *name, DBusMessageIter *value)
+                    {
+        if (std::strcmp(name, "Adapter") == 0)
+            device.adapter = readString(arena, value);
+        else if (std::strcmp(name, "Address") == 0)
+            device.address = readString(arena, value);
+        else if (std::strcmp(name, "Name") == 0)
+            device.name = readString(arena, value);
+        else if (std::strcmp(name, "Connected") == 0)
+            device.connected = readBool(value);
+        else if (std::strcmp(name, "ServicesResolved") == 0)
+            device.servicesResolved = readBool(value); });
+    devices.push_back(device);
+}
+
+void ObjectTree::parseService(DBusMessageIter *propsIter, const char *path)
+{
+    ManagedService service = {arena.copyString(path), EMPTY_STRING, EMPTY_STRING, false};
+    forEachProperty(propsIter, [&](const char *name, DBusMessageIter *value)
+                    {
+        if (std::strcmp(name, "Device") == 0)
+            service.device = readString(arena, value);
+        else if (std::strcmp(name, "UUID") == 0)
+            service.uuid = readString(arena, value);
+        else if (std::strcmp(name, "Primary") == 0)
+            service.primary = readBool(value); });
+    services.push_back(service);
+}
+
+void ObjectTree::parseCharacteristic(DBusMessageIter *propsIter, const char *path)
+{
+    ManagedCharacteristic characteristic = {arena.copyString(path), EMPTY_STRING, EMPTY_STRING, 0};
+    forEachProperty(propsIter, [&](const char *name, DBusMessageIter *value)
+                    {
+        if (std::strcmp(name, "Service") == 0)
+            characteristic.service = readString(arena, value);
+        else if (std::strcmp(name, "UUID") == 0)
+            characteristic.uuid = readString(arena, value);
+        else if (std::strcmp(name, "Flags") == 0)
+            characteristic.flags = readFlags(value); });
+    characteristics.push_back(characteristic);
+}
+
+// Release the previous snapshot; vectors keep their capacity for the next refresh
+void ObjectTree::clear()
+{
+    adapters.clear();
+    devices.clear();
+    services.clear();
+    characteristics.clear();
+    arena.reset();
+}
+
+const std::vector<ManagedAdapter> &ObjectTree::getAdapters() const
+{
+    return adapters;
+}
+
+const std::vector<ManagedDevice> &ObjectTree::getDevices() const
+{
+    return devices;
+}
+
+const std::vector<ManagedService> &ObjectTree::getServices() const
+{
+    return services;
+}
+
+const std::vector<ManagedCharacteristic> &ObjectTree::getCharacteristics() const
+{
+    return characteristics;
+}
+
+size_t ObjectTree::getArenaBytes() const
+{
+    return arena.bytesUsed();
+}
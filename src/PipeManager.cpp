@@ -24,6 +24,7 @@ void PipeManager::addPipe(const BLEPipe &pipe)
     std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
                    [](unsigned char c)
                    { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
 
     // Check for duplicate UUID
     if (pipes.find(lowerUUID) != pipes.end())
@@ -43,6 +44,7 @@ bool PipeManager::removePipeByUUID(const std::string &uuid)
     std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
                    [](unsigned char c)
                    { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
 
     auto it = pipes.find(lowerUUID);
     if (it != pipes.end())
@@ -58,6 +60,101 @@ bool PipeManager::removePipeByUUID(const std::string &uuid)
     }
 }
 
+// Change the type of a pipe by UUID
+bool PipeManager::setPipeType(const std::string &uuid, PipeType type)
+{
+    std::string lowerUUID = uuid;
+    std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
+                   [](unsigned char c)
+                   { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
+
+    auto it = pipes.find(lowerUUID);
+    if (it == pipes.end())
+    {
+        std::cerr << "[PipeManager] Error: Pipe with UUID " << lowerUUID << " not found." << std::endl;
+        return false;
+    }
+
+    it->second.type = type;
+    std::cout << "[PipeManager] Pipe " << lowerUUID << " set to Type=" << static_cast<int>(type) << std::endl;
+    return true;
+}
+
+// Change the default write mode of a pipe by UUID
+bool PipeManager::setPipeWriteMode(const std::string &uuid, WriteMode mode)
+{
+    std::string lowerUUID = uuid;
+    std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
+                   [](unsigned char c)
+                   { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
+
+    auto it = pipes.find(lowerUUID);
+    if (it == pipes.end())
+    {
+        std::cerr << "[PipeManager] Error: Pipe with UUID " << lowerUUID << " not found." << std::endl;
+        return false;
+    }
+
+    it->second.writeMode = mode;
+    std::cout << "[PipeManager] Pipe " << lowerUUID << " set to WriteMode=" << static_cast<int>(mode) << std::endl;
+    return true;
+}
+
+// Change the default timeout of blocking calls on a pipe by UUID
+bool PipeManager::setPipeTimeout(const std::string &uuid, int timeoutMs)
+{
+    std::string lowerUUID = uuid;
+    std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
+                   [](unsigned char c)
+                   { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
+
+    auto it = pipes.find(lowerUUID);
+    if (it == pipes.end())
+    {
+        std::cerr << "[PipeManager] Error: Pipe with UUID " << lowerUUID << " not found." << std::endl;
+        return false;
+    }
+
+    it->second.timeoutMs = timeoutMs;
+    std::cout << "[PipeManager] Pipe " << lowerUUID << " set to Timeout=" << timeoutMs << " ms" << std::endl;
+    return true;
+}
+
+// Change the path of a pipe by UUID
+bool PipeManager::setPipePath(const std::string &uuid, const std::string &path)
+{
+    std::string lowerUUID = uuid;
+    std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
+                   [](unsigned char c)
+                   { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
+
+    auto it = pipes.find(lowerUUID);
+    if (it == pipes.end())
+    {
+        std::cerr << "[PipeManager] Error: Pipe with UUID " << lowerUUID << " not found." << std::endl;
+        return false;
+    }
+
+    it->second.path = path;
+    return true;
+}
+
+// Check whether a pipe is registered
+bool PipeManager::hasPipe(const std::string &uuid) const
+{
+    std::string lowerUUID = uuid;
+    std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
+                   [](unsigned char c)
+                   { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
+
+    return pipes.find(lowerUUID) != pipes.end();
+}
+
 // Get a pipe by UUID
 BLEPipe PipeManager::getPipeByUUID(const std::string &uuid) const
 {
@@ -65,6 +162,7 @@ BLEPipe PipeManager::getPipeByUUID(const std::string &uuid) const
     std::transform(lowerUUID.begin(), lowerUUID.end(), lowerUUID.begin(),
                    [](unsigned char c)
                    { return std::tolower(c); });
+    std::lock_guard<std::mutex> lock(pipesMutex);
 
     auto it = pipes.find(lowerUUID);
     if (it != pipes.end())
@@ -82,6 +180,7 @@ BLEPipe PipeManager::getPipeByUUID(const std::string &uuid) const
 // Get all pipes
 std::vector<BLEPipe> PipeManager::getAllPipes() const
 {
+    std::lock_guard<std::mutex> lock(pipesMutex);
     std::vector<BLEPipe> allPipes;
     for (const auto &pair : pipes)
     {
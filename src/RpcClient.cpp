@@ -0,0 +1,252 @@
+// src/RpcClient.cpp
+
+#include "RpcClient.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+RpcClient::RpcClient(BLEManager &bleMgr, const std::string &rxUUID_, const std::string &txUUID_)
+    : bleManager(bleMgr), rxUUID(rxUUID_), txUUID(txUUID_), subscriptionId(-1), nextId(1),
+      completedCount(0), timeoutCount(0), unmatchedCount(0), totalLatencyMs(0.0), maxLatencyMs(0.0)
+{
+    std::cout << "[RpcClient] Constructor called." << std::endl;
+}
+
+RpcClient::~RpcClient()
+{
+    std::cout << "[RpcClient] Destructor called." << std::endl;
+    close();
+}
+
+// Subscribe to the TX notifications
+bool RpcClient::open()
+{
+    if (subscriptionId >= 0)
+    {
+        return true;
+    }
+
+    subscriptionId = bleManager.subscribeToPipe(txUUID, [this](const std::string &value)
+                                                { onNotification(value); });
+    if (subscriptionId < 0)
+    {
+        std::cerr << "[RpcClient] Failed to subscribe to " << txUUID << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Unsubscribe and cancel the requests in flight
+void RpcClient::close()
+{
+    if (subscriptionId >= 0)
+    {
+        bleManager.unsubscribeFromPipe(subscriptionId);
+        subscriptionId = -1;
+    }
+
+    std::map<uint32_t, PendingRequest> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        cancelled.swap(pending);
+    }
+
+    RpcResult result = {RpcStatus::Cancelled, "", 0.0};
+    for (auto &entry : cancelled)
+    {
+        entry.second.callback(result);
+    }
+}
+
+// Send a request with a callback
+uint32_t RpcClient::call(const std::string &payload, int timeoutMs, RpcCallback callback)
+{
+    if (subscriptionId < 0)
+    {
+        std::cerr << "[RpcClient] Call before open()." << std::endl;
+        RpcResult result = {RpcStatus::SendFailed, "", 0.0};
+        callback(result);
+        return 0;
+    }
+
+    uint32_t id;
+    {
+        // Register first: the response can be dispatched while the write is in progress
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        id = nextId++;
+        if (nextId == 0)
+        {
+            nextId = 1;
+        }
+
+        PendingRequest request;
+        request.callback = callback;
+        request.sentAt = std::chrono::steady_clock::now();
+        request.deadline = request.sentAt + std::chrono::milliseconds(timeoutMs);
+        pending[id] = request;
+    }
+
+    if (!bleManager.writeToPipe(rxUUID, std::to_string(id) + ":" + payload))
+    {
+        bool wasPending;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            wasPending = pending.erase(id) > 0;
+        }
+        if (wasPending)
+        {
+            RpcResult result = {RpcStatus::SendFailed, "", 0.0};
+            callback(result);
+        }
+        return 0;
+    }
+
+    return id;
+}
+
+// Send a request and get its result as a future
+std::future<RpcResult> RpcClient::call(const std::string &payload, int timeoutMs)
+{
+    std::shared_ptr<std::promise<RpcResult>> promise = std::make_shared<std::promise<RpcResult>>();
+    std::future<RpcResult> future = promise->get_future();
+    call(payload, timeoutMs, [promise](const RpcResult &result)
+         { promise->set_value(result); });
+    return future;
+}
+
+// Send a request and poll until its result is known
+RpcResult RpcClient::callSync(const std::string &payload, int timeoutMs)
+{
+    std::future<RpcResult> future = call(payload, timeoutMs);
+    while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        poll(timeoutMs);
+    }
+    return future.get();
+}
+
+// Dispatch notifications and expire requests
+void RpcClient::poll(int timeoutMs)
+{
+    // Don't sleep past the nearest deadline
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto now = std::chrono::steady_clock::now();
+        for (const auto &entry : pending)
+        {
+            long long untilDeadline = std::chrono::duration_cast<std::chrono::milliseconds>(entry.second.deadline - now).count();
+            if (untilDeadline < timeoutMs)
+            {
+                timeoutMs = untilDeadline > 0 ? static_cast<int>(untilDeadline) : 0;
+            }
+        }
+    }
+
+    bleManager.processEvents(timeoutMs);
+    expireRequests();
+}
+
+// Match a TX notification to its request
+void RpcClient::onNotification(const std::string &value)
+{
+    size_t separator = value.find(':');
+    char *end = nullptr;
+    unsigned long id = separator == std::string::npos ? 0 : std::strtoul(value.c_str(), &end, 10);
+
+    PendingRequest request;
+    RpcResult result;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto it = id == 0 || end != value.c_str() + separator ? pending.end() : pending.find(static_cast<uint32_t>(id));
+        if (it == pending.end())
+        {
+            unmatchedCount++;
+            return;
+        }
+
+        request = it->second;
+        pending.erase(it);
+
+        result.status = RpcStatus::Ok;
+        result.response = value.substr(separator + 1);
+        result.latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - request.sentAt).count();
+
+        completedCount++;
+        totalLatencyMs += result.latencyMs;
+        if (result.latencyMs > maxLatencyMs)
+        {
+            maxLatencyMs = result.latencyMs;
+        }
+    }
+
+    request.callback(result);
+}
+
+// Fail the requests whose deadline has passed
+void RpcClient::expireRequests()
+{
+    std::vector<PendingRequest> expired;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (it->second.deadline <= now)
+            {
+                std::cerr << "[RpcClient] Request " << it->first << " timed out." << std::endl;
+                expired.push_back(it->second);
+                it = pending.erase(it);
+                timeoutCount++;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    RpcResult result = {RpcStatus::Timeout, "", 0.0};
+    for (const PendingRequest &request : expired)
+    {
+        result.latencyMs = std::chrono::duration<double, std::milli>(request.deadline - request.sentAt).count();
+        request.callback(result);
+    }
+}
+
+// Number of requests in flight
+size_t RpcClient::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return pending.size();
+}
+
+unsigned long RpcClient::getCompletedCount() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return completedCount;
+}
+
+unsigned long RpcClient::getTimeoutCount() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return timeoutCount;
+}
+
+unsigned long RpcClient::getUnmatchedCount() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return unmatchedCount;
+}
+
+double RpcClient::getAverageLatencyMs() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return completedCount ? totalLatencyMs / completedCount : 0.0;
+}
+
+double RpcClient::getMaxLatencyMs() const
+{
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return maxLatencyMs;
+}
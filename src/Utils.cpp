@@ -1,8 +1,10 @@
 // src/Utils.cpp
 #include "Utils.h"
 #include "BLETypes.h" // Ensure this is included
+#include "IntrospectionParser.h"
 #include <algorithm>  // Required for std::transform
 #include <cctype>     // Required for std::tolower
+#include <iostream>
 
 // Implement parseBluetoothDevice
 BluetoothDevice Utils::parseBluetoothDevice(const std::string &objectPath, DbusConnection *dbusConn)
@@ -18,24 +20,72 @@ BluetoothDevice Utils::parseBluetoothDevice(const std::string &objectPath, DbusC
     return device;
 }
 
-// Implement extractChildPaths
+// Path of a child node, built in a single allocation
+static std::string childPath(const std::string &parentPath, const StringView &name)
+{
+    std::string path;
+    path.reserve(parentPath.size() + 1 + name.size);
+    path.append(parentPath).append(1, '/').append(name.data, name.size);
+    return path;
+}
+
+// Implement extractChildPaths: direct children of the introspected node only
 std::vector<std::string> Utils::extractChildPaths(const std::string &xmlData, const std::string &parentPath)
 {
     std::vector<std::string> childPaths;
-    std::string searchStr = "<node name=\"";
-    size_t pos = 0;
+    std::vector<StringView> rootInterfaces;
+    std::vector<IntrospectedNode> children;
 
-    while ((pos = xmlData.find(searchStr, pos)) != std::string::npos)
+    if (!IntrospectionParser::parseNode(xmlData.data(), xmlData.size(), rootInterfaces, children))
     {
-        pos += searchStr.length();
-        size_t end = xmlData.find("\"", pos);
-        if (end == std::string::npos)
-            break;
-
-        std::string childName = xmlData.substr(pos, end - pos);
-        std::string childPath = parentPath + "/" + childName;
-        childPaths.push_back(childPath);
-        pos = end;
+        std::cerr << "[Utils] Malformed introspection XML for " << parentPath << "." << std::endl;
+    }
+
+    childPaths.reserve(children.size());
+    for (const IntrospectedNode &child : children)
+    {
+        childPaths.push_back(childPath(parentPath, child.name));
+    }
+
+    return childPaths;
+}
+
+// Implement extractChildPaths filtered on a GATT interface
+std::vector<std::string> Utils::extractChildPaths(const std::string &xmlData, const std::string &parentPath,
+                                                  const char *iface, const char *namePrefix)
+{
+    std::vector<std::string> childPaths;
+    std::vector<StringView> rootInterfaces;
+    std::vector<IntrospectedNode> children;
+
+    if (!IntrospectionParser::parseNode(xmlData.data(), xmlData.size(), rootInterfaces, children))
+    {
+        std::cerr << "[Utils] Malformed introspection XML for " << parentPath << "." << std::endl;
+    }
+
+    for (const IntrospectedNode &child : children)
+    {
+        bool keep = false;
+        if (child.interfaces.empty())
+        {
+            keep = child.name.startsWith(namePrefix);
+        }
+        else
+        {
+            for (const StringView &childIface : child.interfaces)
+            {
+                if (childIface.equals(iface))
+                {
+                    keep = true;
+                    break;
+                }
+            }
+        }
+
+        if (keep)
+        {
+            childPaths.push_back(childPath(parentPath, child.name));
+        }
     }
 
     return childPaths;
@@ -50,3 +100,22 @@ std::string Utils::toLower(const std::string &str)
                    { return std::tolower(c); });
     return lowerStr;
 }
+
+// Implement matchesUuidFilter
+bool Utils::matchesUuidFilter(const std::set<std::string> &filter, const std::string &uuid)
+{
+    if (filter.empty())
+    {
+        return true;
+    }
+
+    std::string lowerUUID = toLower(uuid);
+    for (const std::string &entry : filter)
+    {
+        if (toLower(entry) == lowerUUID)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,143 @@
+// test/ThreadingTest.cpp
+
+// Readers race a link drop: several threads read a pipe while another runs
+// processEvents(), then the device is disconnected behind the framework's back
+// and reconnected by link supervision. Build the framework and this test with
+// -DBLE_SANITIZE_THREAD=ON to have ThreadSanitizer check the run.
+//
+// Usage: test_threading <MAC address> <readable characteristic UUID>
+
+#include "BLEManager.h"
+#include <dbus/dbus.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static const int READER_COUNT = 4;
+static const int PHASE_MS = 500;
+static const int RECONNECT_TIMEOUT_MS = 5000;
+
+// Disconnect the device on a connection of our own, so the framework only
+// learns about it from the Device1.Connected signal
+static bool disconnectBehindFramework(const std::string &devicePath)
+{
+    DBusError error;
+    dbus_error_init(&error);
+    DBusConnection *conn = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+    if (!conn)
+    {
+        std::cerr << "Failed to open a D-Bus connection: " << error.message << std::endl;
+        dbus_error_free(&error);
+        return false;
+    }
+    dbus_connection_set_exit_on_disconnect(conn, FALSE);
+
+    DBusMessage *msg = dbus_message_new_method_call("org.bluez", devicePath.c_str(), "org.bluez.Device1", "Disconnect");
+    DBusMessage *reply = dbus_connection_send_with_reply_and_block(conn, msg, 5000, &error);
+    dbus_message_unref(msg);
+    bool ok = reply != nullptr;
+    if (reply)
+    {
+        dbus_message_unref(reply);
+    }
+    else
+    {
+        std::cerr << "Disconnect failed: " << error.message << std::endl;
+        dbus_error_free(&error);
+    }
+
+    dbus_connection_close(conn);
+    dbus_connection_unref(conn);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <MAC address> <readable characteristic UUID>" << std::endl;
+        return 2;
+    }
+    std::string macAddress = argv[1];
+    std::string uuid = argv[2];
+
+    BLEManager bleManager;
+    if (!bleManager.initialize() || !bleManager.connectToDevice(macAddress) || !bleManager.listAllCharacteristics())
+    {
+        std::cerr << "Failed to bring up " << macAddress << "." << std::endl;
+        return 1;
+    }
+
+    ReconnectPolicy policy;
+    policy.initialDelayMs = 100;
+    policy.jitter = 0.0;
+    if (!bleManager.superviseLink(policy))
+    {
+        return 1;
+    }
+    std::string devicePath = bleManager.getSelectedDevicePath();
+
+    std::atomic<bool> stop(false);
+    std::atomic<bool> sawDown(false);
+    std::atomic<unsigned long> reads(0);
+    std::atomic<unsigned long> failedReads(0);
+
+    // Event loop: signal handlers, reconnects and restores run here
+    std::thread eventLoop([&]()
+                          {
+        while (!stop)
+        {
+            bleManager.processEvents(20);
+            if (bleManager.getLinkState() != LinkState::Up)
+            {
+                sawDown = true;
+            }
+        } });
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READER_COUNT; ++i)
+    {
+        readers.push_back(std::thread([&]()
+                                      {
+            while (!stop)
+            {
+                std::string value;
+                if (bleManager.readFromPipe(uuid, value))
+                {
+                    reads++;
+                }
+                else
+                {
+                    failedReads++;
+                }
+            } }));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(PHASE_MS));
+    bool disconnected = disconnectBehindFramework(devicePath);
+
+    // Wait for the drop to be seen and the link to come back
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECONNECT_TIMEOUT_MS);
+    while (std::chrono::steady_clock::now() < deadline && !(sawDown && bleManager.getLinkState() == LinkState::Up))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    unsigned long readsBeforeRestore = reads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(PHASE_MS));
+
+    stop = true;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+    eventLoop.join();
+
+    bool restored = sawDown && bleManager.getLinkState() == LinkState::Up;
+    bool resumed = reads > readsBeforeRestore;
+    std::cout << "Reads: " << reads << " succeeded, " << failedReads << " failed; link "
+              << (restored ? "dropped and restored" : "not restored") << ", reads "
+              << (resumed ? "resumed" : "did not resume") << "." << std::endl;
+    return disconnected && restored && resumed ? 0 : 1;
+}
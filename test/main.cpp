@@ -22,41 +22,47 @@ const std::string CHARACTERISTIC_HANDSHAKE_TX_UUID = "12345678-1234-5678-1234-56
 // Function Definitions
 // ----------------------
 
-// Function to initialize BLE and connect to ESP32
-bool initializeBLE(BLEManager &bleManager, const std::string &serviceUUID)
+// Function to bring up the ESP32 session: connect, discover, configure and handshake
+bool bringUpESP32(BLEManager &bleManager, const std::string &serviceUUID)
 {
-    std::cout << "Initializing BLE Manager..." << std::endl;
-    if (!bleManager.initialize())
-    {
-        std::cerr << "Failed to initialize BLE Manager." << std::endl;
-        return false;
-    }
+    std::cout << "Bringing up BLE session..." << std::endl;
 
-    std::cout << "Listing connected BLE devices..." << std::endl;
-    std::vector<BluetoothDevice> devices = bleManager.listConnectedDevices();
+    // Reuse the characteristic table of known devices across runs
+    bleManager.enableGattCache("gatt_cache.bin");
 
-    if (devices.empty())
+    // Radio settings, validated before anything is sent
+    DeviceConfig config;
+    config.setFrequencyMHz(433.0);
+    config.setModulation(Modulation::OOK);
+    config.setPowerDbm(10);
+    config.setRole(RadioRole::Transmitter);
+
+    std::string radioConfig;
+    if (!config.encode(ConfigEncoding::LegacyAscii, radioConfig))
     {
-        std::cerr << "No connected BLE devices found." << std::endl;
+        std::cerr << "Invalid radio configuration." << std::endl;
         return false;
     }
 
-    // Select the first connected device
-    BluetoothDevice selectedDevice = devices.front();
-    std::cout << "Selected Device: " << selectedDevice.name << " [" << selectedDevice.macAddress << "]" << std::endl;
+    BringUpPlan plan;
+    // Only discover the characteristics of our service
+    plan.filter.serviceUUIDs.insert(serviceUUID);
+    plan.configUUID = CHARACTERISTIC_CONFIG_UUID;
+    plan.configData = radioConfig;
+    plan.handshakeRxUUID = CHARACTERISTIC_HANDSHAKE_RX_UUID;
+    plan.handshakeTxUUID = CHARACTERISTIC_HANDSHAKE_TX_UUID;
+    plan.handshakeRequest = "Handshake_Request";
+    plan.pipeTypes[CHARACTERISTIC_MESSAGE_UUID] = PipeType::Message;
+    plan.pipeTypes[CHARACTERISTIC_LOG_UUID] = PipeType::Log;
 
-    if (!bleManager.connectToDevice(selectedDevice.macAddress))
+    BringUpReport report;
+    if (!bleManager.bringUp(plan, report))
     {
-        std::cerr << "Failed to connect to the BLE device." << std::endl;
+        std::cerr << "Failed to bring up the BLE session." << std::endl;
         return false;
     }
 
-    std::cout << "Listing all characteristics..." << std::endl;
-    if (!bleManager.listAllCharacteristics())
-    {
-        std::cerr << "Failed to list characteristics." << std::endl;
-        return false;
-    }
+    std::cout << "Connected to " << report.deviceAddress << ", handshake response: " << report.handshakeResponse << std::endl;
 
     CharacteristicManager *charManager = bleManager.getCharacteristicManager();
     if (charManager)
@@ -79,56 +85,6 @@ bool initializeBLE(BLEManager &bleManager, const std::string &serviceUUID)
     return true;
 }
 
-// Function to configure ESP32 radio settings
-bool configureESP32(BLEManager &bleManager)
-{
-    std::cout << "Configuring ESP32 radio settings..." << std::endl;
-    std::string configCommand = "FREQ:433.0;MOD:OOK;PWR:10;ROLE:Transmitter;";
-    if (!bleManager.writeToPipe(CHARACTERISTIC_CONFIG_UUID, configCommand))
-    {
-        std::cerr << "Failed to write configuration to ESP32." << std::endl;
-        return false;
-    }
-    std::cout << "Configuration command sent successfully." << std::endl;
-    return true;
-}
-
-// Function to perform handshake with ESP32
-bool performHandshake(BLEManager &bleManager)
-{
-    std::cout << "Performing handshake with ESP32..." << std::endl;
-    std::string handshakeMessage = "Handshake_Request";
-
-    if (!bleManager.writeToPipe(CHARACTERISTIC_HANDSHAKE_RX_UUID, handshakeMessage))
-    {
-        std::cerr << "Failed to send handshake message to ESP32." << std::endl;
-        return false;
-    }
-
-    std::cout << "Handshake message sent. Waiting for response..." << std::endl;
-    std::string response;
-    bool received = false;
-    for (int i = 0; i < 5; ++i)
-    {
-        if (bleManager.readFromPipe(CHARACTERISTIC_HANDSHAKE_TX_UUID, response))
-        {
-            std::cout << "Received Handshake Response: " << response << std::endl;
-            received = true;
-            break;
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
-
-    if (!received)
-    {
-        std::cerr << "Handshake response not received within timeout." << std::endl;
-        return false;
-    }
-
-    std::cout << "Handshake completed successfully." << std::endl;
-    return true;
-}
-
 // Function to send a message to ESP32
 bool sendMessage(BLEManager &bleManager, const std::string &message)
 {
@@ -154,24 +110,10 @@ int main()
 {
     BLEManager bleManager;
 
-    // Step 1: Initialize BLE and connect to ESP32
-    if (!initializeBLE(bleManager, SERVICE_UUID))
-    {
-        std::cerr << "BLE Initialization and connection failed." << std::endl;
-        return 1;
-    }
-
-    // Step 2: Configure ESP32 radio settings
-    if (!configureESP32(bleManager))
-    {
-        std::cerr << "ESP32 Configuration failed." << std::endl;
-        return 1;
-    }
-
-    // Step 3: Perform handshake
-    if (!performHandshake(bleManager))
+    // Steps 1-3: Connect, configure and handshake with ESP32 as one pipeline
+    if (!bringUpESP32(bleManager, SERVICE_UUID))
     {
-        std::cerr << "Handshake with ESP32 failed." << std::endl;
+        std::cerr << "BLE bring-up failed." << std::endl;
         return 1;
     }
 